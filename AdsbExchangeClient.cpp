@@ -26,87 +26,371 @@ See more at http://blog.squix.ch
 #include "AdsbExchangeClient.h"
 
 
-AdsbExchangeClient::AdsbExchangeClient() {
+AdsbExchangeClient::AdsbExchangeClient(FeedMerger* merger) {
+  this->merger = merger;
+  store = merger->getStore();
+  source = merger->addSource("ADSBx");
+}
 
+AdsbExchangeClient::~AdsbExchangeClient() {
+  delete inflater;
 }
 
-void AdsbExchangeClient::updateVisibleAircraft(String searchQuery) {
-  JsonStreamingParser parser;
-  parser.setListener(this);
-  WiFiClient client;
+void AdsbExchangeClient::setCompression(boolean enabled) {
+  compression = enabled;
+}
 
-  // http://public-api.adsbexchange.com/VirtualRadar/AircraftList.json?lat=47.437691&lng=8.568854&fDstL=0&fDstU=20&fAltL=0&fAltU=5000
-  const char host[] = "global.adsbexchange.com";
-  String url = "/VirtualRadar/AircraftList.json?" + searchQuery;
+void AdsbExchangeClient::startUpdate(String searchQuery) {
+  if (fetchState != FetchState::Idle) {
+    Serial.println("Abandoning the previous update");
+    client.stop();
+  }
+  partialUpdate = false;
+  updateQuery = searchQuery;
+  deltaUpdate = lastDv[0] != '\0';
+  if (deltaUpdate) {
+    searchQuery += String("&ldv=") + lastDv;
+  }
+  trailRequests = 0;
+  nextTrailRequest = 0;
+  fetchStats = {};
+  startRequest(searchQuery);
+}
 
-  const int httpPort = 80;
-  if (!client.connect(host, httpPort)) {
-    Serial.println("connection failed");
-    return;
+void AdsbExchangeClient::updateVisibleAircraft(String searchQuery) {
+  startUpdate(searchQuery);
+  while (poll()) {
+    yield();
   }
+}
+
+boolean AdsbExchangeClient::isUpdating() {
+  return fetchState != FetchState::Idle;
+}
 
+uint8_t AdsbExchangeClient::getSource() {
+  return source;
+}
 
-  //Serial.print("Requesting URL: ");
-  //Serial.println(url);
+FetchStats AdsbExchangeClient::getLastFetchStats() {
+  return lastFetchStats;
+}
 
-  // This will send the request to the server
-  client.print(String("GET ") + url + " HTTP/1.1\r\n" +
-               "Host: " + host + "\r\n" +
-               "Connection: close\r\n\r\n");
+void AdsbExchangeClient::startRequest(String query) {
+  requestQuery = query;
+  parser.setListener(this);
+  parser.reset();
+  response.reset();
+  inflating = false;
+  fetchState = FetchState::Connect;
+  fetchMillis = millis();
+}
 
-  int retryCounter = 0;
-  while(!client.available()) {
-    Serial.println(".");
-    delay(1000);
-    retryCounter++;
-    if (retryCounter > 10) {
-      return;
+// http://public-api.adsbexchange.com/VirtualRadar/AircraftList.json?lat=47.437691&lng=8.568854&fDstL=0&fDstU=20&fAltL=0&fAltU=5000
+boolean AdsbExchangeClient::poll() {
+  const char host[] = "global.adsbexchange.com";
+  switch (fetchState) {
+    case FetchState::Idle:
+      return false;
+    case FetchState::Connect: {
+      reusedConnection = client.connected();
+      if (reusedConnection) {
+        fetchState = FetchState::Send;
+        break;
+      }
+      // Name lookup and TCP handshake still block in WiFiClient
+      unsigned long start = micros();
+      boolean connected = client.connect(host, 80);
+      uint32_t connectMicros = micros() - start;
+      fetchStats.connects++;
+      fetchStats.connectMicros += connectMicros;
+      Metrics.record(Metric::AdsbConnect, connectMicros / 1000);
+      if (!connected) {
+        Serial.println("connection failed");
+        finishRequest();
+      } else {
+        client.setNoDelay(false);
+        fetchState = FetchState::Send;
+      }
+      break;
     }
+    case FetchState::Send:
+      //Serial.print("Requesting URL: ");
+      //Serial.println(requestQuery);
+      transferStartMicros = micros();
+      firstByteMicros = 0;
+      client.print(String("GET /VirtualRadar/AircraftList.json?") + requestQuery + " HTTP/1.1\r\n" +
+                   "Host: " + host + "\r\n" +
+                   (compression ? "Accept-Encoding: gzip, deflate\r\n" : "") +
+                   "Connection: keep-alive\r\n\r\n");
+      fetchState = FetchState::Headers;
+      fetchMillis = millis();
+      break;
+    case FetchState::Headers:
+    case FetchState::Body:
+      readResponse();
+      break;
   }
+  return fetchState != FetchState::Idle;
+}
 
-  int pos = 0;
-  boolean isBody = false;
-  char c;
-
-  int size = 0;
-  client.setNoDelay(false);
-  while(client.connected()) {
-    while((size = client.available()) > 0) {
-      c = client.read();
-      if (c == '{' || c == '[') {
-        isBody = true;
+void AdsbExchangeClient::readResponse() {
+  char buffer[HTTP_READ_BUFFER_LENGTH];
+  for (int reads = 0; reads < HTTP_READS_PER_POLL && !response.isDone(); reads++) {
+    int size = client.available();
+    if (size <= 0) {
+      break;
+    }
+    size = client.read((uint8_t*) buffer, min(size, HTTP_READ_BUFFER_LENGTH));
+    if (size <= 0) {
+      break;
+    }
+    fetchMillis = millis();
+    reusedConnection = false;
+    if (firstByteMicros == 0) {
+      firstByteMicros = micros();
+      uint32_t waited = firstByteMicros - transferStartMicros;
+      fetchStats.firstByteMicros += waited;
+      Metrics.record(Metric::AdsbFirstByte, waited / 1000);
+    }
+    fetchStats.receivedBytes += size;
+    size_t bodyLength = response.parse(buffer, size);
+    if (response.isInBody()) {
+      fetchState = FetchState::Body;
+      if (!response.isSuccess()) {
+        // The body is an error page. An ldv the server rejects is not sent
+        // again, the next poll asks for the full list.
+        Serial.println("HTTP error " + String(response.getStatusCode()));
+        if (!partialUpdate) {
+          lastDv[0] = '\0';
+        }
+        finishRequest();
+        return;
       }
-      if (isBody) {
-        parser.parse(c);
+    }
+    unsigned long parseStart = micros();
+    parseBody(buffer, bodyLength, response.getContentEncoding());
+    fetchStats.parseMicros += micros() - parseStart;
+    if (inflating && inflater->hasError()) {
+      if (inflater->isWindowTooSmall()) {
+        // Asked again without compression, the parser starts over on the
+        // new answer. The window is not needed any more.
+        Serial.println("Server needs a larger window, compression off");
+        compression = false;
+        delete inflater;
+        inflater = nullptr;
+        client.stop();
+        startRequest(requestQuery);
+      } else {
+        Serial.println("Could not inflate the answer");
+        finishRequest();
       }
+      return;
     }
   }
-  endDocument();
+  unsigned long timeout = fetchState == FetchState::Headers ? HTTP_RESPONSE_TIMEOUT_MILLIS : HTTP_IDLE_TIMEOUT_MILLIS;
+  // The rest of the response must be read even if the document is complete,
+  // or it would end up in front of the next response on the connection
+  if (response.isDone()) {
+    finishRequest();
+  } else if (!client.connected()) {
+    if (reusedConnection) {
+      // The server closed the idle connection before it got the request
+      client.stop();
+      fetchState = FetchState::Connect;
+    } else {
+      if (!parser.isDone()) {
+        Serial.println("Connection closed before the end of the document");
+      }
+      finishRequest();
+    }
+  } else if (millis() - fetchMillis > timeout) {
+    Serial.println("Timeout waiting for the server");
+    finishRequest();
+  }
 }
 
+// Hands the body to the JSON parser, through the inflater if the server
+// compressed it
+void AdsbExchangeClient::parseBody(const char* data, size_t length, HttpEncoding encoding) {
+  if (encoding == HttpEncoding::Identity) {
+    fetchStats.documentBytes += length;
+    parser.parse(data, length);
+    return;
+  }
+  if (!inflating) {
+    if (!inflater) {
+      inflater = new Inflater();
+    }
+    inflater->reset(encoding == HttpEncoding::Gzip ? InflateFormat::Gzip : InflateFormat::Deflate);
+    inflating = true;
+  }
+  char inflated[HTTP_READ_BUFFER_LENGTH];
+  size_t in = 0;
+  size_t out;
+  do {
+    size_t consumed;
+    out = inflater->inflate((const uint8_t*) data + in, length - in, consumed, (uint8_t*) inflated, sizeof(inflated));
+    in += consumed;
+    fetchStats.documentBytes += out;
+    parser.parse(inflated, out);
+  } while (out == sizeof(inflated) || (in < length && !inflater->isDone() && !inflater->hasError()));
+}
+
+void AdsbExchangeClient::parseRecordedBody(const char* data, size_t length, HttpEncoding encoding) {
+  parser.setListener(this);
+  parser.reset();
+  inflating = false;
+  for (size_t i = 0; i < length; i += HTTP_READ_BUFFER_LENGTH) {
+    parseBody(data + i, min(length - i, (size_t) HTTP_READ_BUFFER_LENGTH), encoding);
+  }
+}
 
-void AdsbExchangeClient::whitespace(char c) {
+// Moves on to the trail requests once the list is in, then back to idle.
+// The connection stays open for the next request if the server allows it.
+void AdsbExchangeClient::finishRequest() {
+  if (!response.isDone() || !response.isKeepAlive()) {
+    client.stop();
+  }
+  if (fetchState == FetchState::Headers || fetchState == FetchState::Body) {
+    fetchStats.requests++;
+    fetchStats.transferMicros += micros() - transferStartMicros;
+    if (firstByteMicros != 0) {
+      Metrics.record(Metric::AdsbTransfer, (micros() - firstByteMicros) / 1000);
+    }
+  }
+  if (!partialUpdate) {
+    fetchStats.complete = response.isSuccess() && parser.isDone();
+    deltaUpdate = false;
+    // No trails from a server that just failed, the next poll tries again
+    for (int i = 0; fetchStats.complete && i < store->getNumberOfAircrafts() && trailRequests < MAX_TRAIL_REQUESTS; i++) {
+      if (store->needsTrail(i)) {
+        trailIcaos[trailRequests++] = store->getIcao(i);
+      }
+    }
+    partialUpdate = true;
+  } else if (response.isSuccess() && parser.isDone()) {
+    // Also if the answer has no trail, the aircraft is not asked for again
+    int i = store->find(trailIcaos[nextTrailRequest - 1]);
+    if (i >= 0) {
+      store->setTrailLoaded(i);
+    }
+  } else {
+    // The remaining trails wait for the next poll
+    nextTrailRequest = trailRequests;
+  }
+  if (nextTrailRequest < trailRequests) {
+    char icao[7];
+    sprintf(icao, "%06X", trailIcaos[nextTrailRequest++]);
+    startRequest(updateQuery + "&fIcoQ=" + icao + "&trFmt=sa");
+  } else {
+    partialUpdate = false;
+    fetchState = FetchState::Idle;
+    lastFetchStats = fetchStats;
+    recordMetrics();
+    uint16_t overflows = store->getStringPool()->getNumberOfOverflows();
+    if (overflows != stringOverflows) {
+      Serial.println("String pool full, " + String((uint16_t) (overflows - stringOverflows)) + " texts dropped");
+      stringOverflows = overflows;
+    }
+  }
+}
 
+void AdsbExchangeClient::recordMetrics() {
+  Metrics.count(Counter::AdsbPolls);
+  if (!fetchStats.complete) {
+    Metrics.count(Counter::AdsbFailures);
+  }
+  Metrics.count(Counter::AdsbRequests, fetchStats.requests);
+  Metrics.count(Counter::AdsbConnects, fetchStats.connects);
+  Metrics.record(Metric::AdsbParse, fetchStats.parseMicros);
+  Metrics.record(Metric::AdsbBytes, fetchStats.receivedBytes);
+  Metrics.record(Metric::AdsbAircraft, fetchStats.aircraft);
+  Metrics.record(Metric::AdsbDropped, fetchStats.droppedAircraft);
 }
 
 void AdsbExchangeClient::startDocument() {
-  counter = 0;
-  index = -1;
+  depth = 0;
+  acListDepth = 0;
+  currentKey = VrsKey::Unknown;
+  pendingDv[0] = '\0';
+  if (!partialUpdate) {
+    missedAircraft = false;
+  }
 }
 
-void AdsbExchangeClient::key(String key) {
-  currentKey = key;
+// Dispatches on length and first character, which already tells all known
+// keys apart except Spd and Sqk, then confirms the rest with a single
+// compare. Most unknown keys are rejected by the length switch alone.
+VrsKey AdsbExchangeClient::lookupKey(const char* key, size_t length) {
+  VrsKey candidate = VrsKey::Unknown;
+  const char* name = "";
+  switch (length) {
+    case 2:
+      switch (key[0]) {
+        case 'I': candidate = VrsKey::Id; name = "Id"; break;
+        case 'T': candidate = VrsKey::To; name = "To"; break;
+      }
+      break;
+    case 3:
+      switch (key[0]) {
+        case 'A': candidate = VrsKey::Alt; name = "Alt"; break;
+        case 'C': candidate = VrsKey::Cos; name = "Cos"; break;
+        case 'D': candidate = VrsKey::Dst; name = "Dst"; break;
+        case 'L': candidate = VrsKey::Lat; name = "Lat"; break;
+        case 'M': candidate = VrsKey::Mdl; name = "Mdl"; break;
+        case 's': candidate = VrsKey::Stm; name = "stm"; break;
+        case 'S':
+          candidate = key[1] == 'p' ? VrsKey::Spd : VrsKey::Sqk;
+          name = key[1] == 'p' ? "Spd" : "Sqk";
+          break;
+      }
+      break;
+    case 4:
+      switch (key[0]) {
+        case 'C': candidate = VrsKey::Call; name = "Call"; break;
+        case 'F': candidate = VrsKey::From; name = "From"; break;
+        case 'I': candidate = VrsKey::Icao; name = "Icao"; break;
+        case 'L': candidate = VrsKey::Long; name = "Long"; break;
+        case 'T': candidate = VrsKey::Trak; name = "Trak"; break;
+      }
+      break;
+    case 6:
+      switch (key[0]) {
+        case 'a': candidate = VrsKey::AcList; name = "acList"; break;
+        case 'l': candidate = VrsKey::LastDv; name = "lastDv"; break;
+        case 'O': candidate = VrsKey::OpIcao; name = "OpIcao"; break;
+      }
+      break;
+    case 7:
+      candidate = VrsKey::PosTime;
+      name = "PosTime";
+      break;
+    case 8:
+      candidate = VrsKey::PosStale;
+      name = "PosStale";
+      break;
+  }
+  if (candidate == VrsKey::Unknown || memcmp(key, name, length) != 0) {
+    return VrsKey::Unknown;
+  }
+  return candidate;
 }
 
-void AdsbExchangeClient::value(String value) {
-  /*String from = "";
-  String to = "";
-  String altitude = "";
-  String aircraftType = "";
-  String currentKey = "";
-  String operator = "";
+// "LSZH Zürich, Zurich, Switzerland" => "LSZH Zürich", the code and the
+// name are all the display shows of an airport
+static size_t airportLength(const char* value, size_t length) {
+  const char* comma = (const char*) memchr(value, ',', length);
+  return comma ? comma - value : length;
+}
 
+bool AdsbExchangeClient::key(const char* key, size_t length) {
+  currentKey = lookupKey(key, length);
+  return currentKey != VrsKey::Unknown;
+}
 
+void AdsbExchangeClient::value(const char* value, size_t length, JsonValueType type) {
+  /*
  "Type": "A319",
  "Mdl": "Airbus A319 112",
 
@@ -117,158 +401,236 @@ void AdsbExchangeClient::value(String value) {
  "Dst": 6.23,
  "Year": "1996"
  */
-  if (counter >= MAX_AIRCRAFTS - 1) {
-    Serial.println("Max Aircrafts reached....");
+  if (currentKey == VrsKey::LastDv && depth == 1) {
+    size_t dvLength = min(length, (size_t) DATA_VERSION_LENGTH - 1);
+    memcpy(pendingDv, value, dvLength);
+    pendingDv[dvLength] = '\0';
     return;
   }
-  if (currentKey == "Id") {
-
-      counter++;
-      index = counter - 1;
-      aircrafts[index] = {};
-      histories[index] = {};
-      
-      trailIndex = 0;
-      for (int i = 0; i < MAX_HISTORY_TEMP; i++) {
-         positionTemp[i] = {};
-      }
-   
-  } else if (currentKey == "From") {
-    aircrafts[index].from = value;
-    aircrafts[index].fromCode = value.substring(0,4);
-    int indexOfFirstComma = value.indexOf(",");
-    aircrafts[index].fromShort = value.substring(4, indexOfFirstComma);
-  } else if (currentKey == "To") {
-    aircrafts[index].to = value;
-    aircrafts[index].toCode = value.substring(0,4);
-    int indexOfFirstComma = value.indexOf(",");
-    aircrafts[index].toShort = value.substring(4, indexOfFirstComma);
-  } else if (currentKey == "OpIcao") {
-    aircrafts[index].operatorCode = value;
-  } else if (currentKey == "Dst") {
-    aircrafts[index].distance = value.toFloat();
-  } else if (currentKey == "Mdl") {
-    aircrafts[index].aircraftType = value;
-  } else if (currentKey == "Trak") {
-    aircrafts[index].heading = value.toFloat();
-  } else if (currentKey == "Alt") {
-    aircrafts[index].altitude = value.toInt();;
-  } else if (currentKey == "Lat") {
-    aircrafts[index].lat = value.toFloat();
-  } else if (currentKey == "Long") {
-    aircrafts[index].lon = value.toFloat();
-  } else if (currentKey == "Spd") {
-    aircrafts[index].speed = value.toFloat();
-  } else if (currentKey == "Icao") {
-    aircrafts[index].icao = value;
-  } else if (currentKey == "Call") {
-    Serial.println("Saw " + value);
-    aircrafts[index].call = value;
-  } else if (currentKey == "PosStale") {
-    aircrafts[index].posStall = (value == "true");
-  } else if (currentKey == "Cos") {
-    int tempIndex = trailIndex / 4;
-    if (tempIndex < MAX_HISTORY_TEMP) {
-      AircraftPosition position = positionTemp[tempIndex];
-      Coordinates coordinates = position.coordinates;
+  if (currentKey == VrsKey::Stm && depth == 1) {
+    serverClockOffset = atoll(value) - (int64_t) millis();
+    hasServerClock = true;
+    return;
+  }
+  if (acListDepth == 0 || depth <= acListDepth) {
+    return;
+  }
+  StringPool* strings = store->getStringPool();
+  switch (currentKey) {
+    case VrsKey::From:
+      currentFields |= AIRCRAFT_ROUTE;
+      strings->release(current.from);
+      current.from = strings->intern(value, airportLength(value, length));
+      break;
+    case VrsKey::To:
+      currentFields |= AIRCRAFT_ROUTE;
+      strings->release(current.to);
+      current.to = strings->intern(value, airportLength(value, length));
+      break;
+    case VrsKey::OpIcao:
+      currentFields |= AIRCRAFT_ROUTE;
+      strings->release(current.operatorCode);
+      current.operatorCode = strings->intern(value, length);
+      break;
+    case VrsKey::Dst:
+      currentFields |= AIRCRAFT_POSITION;
+      current.distance = atof(value) * 100 + 0.5;
+      break;
+    case VrsKey::Mdl:
+      currentFields |= AIRCRAFT_ROUTE;
+      strings->release(current.model);
+      current.model = strings->intern(value, length);
+      break;
+    case VrsKey::Trak:
+      currentFields |= AIRCRAFT_VELOCITY;
+      current.heading = atof(value) * 10 + 0.5;
+      break;
+    case VrsKey::Alt:
+      currentFields |= AIRCRAFT_ALTITUDE;
+      current.altitude = atoi(value);
+      break;
+    case VrsKey::Lat:
+      currentFields |= AIRCRAFT_POSITION;
+      current.lat = lround(atof(value) * 1e6);
+      break;
+    case VrsKey::Long:
+      currentFields |= AIRCRAFT_POSITION;
+      current.lon = lround(atof(value) * 1e6);
+      break;
+    case VrsKey::Spd:
+      currentFields |= AIRCRAFT_VELOCITY;
+      current.speed = atof(value) + 0.5;
+      break;
+    case VrsKey::Sqk:
+      currentFields |= AIRCRAFT_IDENTITY;
+      current.squawk = atoi(value);
+      break;
+    case VrsKey::Id:
+      // VRS uses the ICAO address as Id. Deltas only carry the Id.
+      identifyAircraft(strtoul(value, nullptr, 10));
+      break;
+    case VrsKey::Icao:
+      identifyAircraft(strtoul(value, nullptr, 16));
+      break;
+    case VrsKey::Call:
+      currentFields |= AIRCRAFT_IDENTITY;
+      // A delta starts from the known call sign, which can be longer
+      memset(current.call, 0, AIRCRAFT_CALL_LENGTH);
+      memcpy(current.call, value, min(length, (size_t) AIRCRAFT_CALL_LENGTH));
+      break;
+    case VrsKey::PosTime:
+      currentPosTime = atoll(value);
+      break;
+    case VrsKey::PosStale:
+      currentPosStale = (type == JsonValueType::True);
+      break;
+    case VrsKey::Cos:
+      // Oldest position first, so each one becomes the newest of the trail
       if (trailIndex % 4 == 0) {
-        coordinates.lat = value.toFloat();
+        trailLat = lround(atof(value) * 1e6);
       } else if (trailIndex % 4 == 1) {
-        coordinates.lon = value.toFloat();
+        trailLon = lround(atof(value) * 1e6);
       } else if (trailIndex % 4 == 3) {
-        position.altitude = value.toInt();
+        currentHistory.append(trailLat, trailLon, atoi(value));
+        currentHasHistory = true;
       }
-      position.coordinates = coordinates;
-      positionTemp[tempIndex] = position;
       trailIndex++;
-    }
-
-  } else if (currentKey == "Trt") {
-    if(aircrafts[index].posStall) {
-      Serial.println("This aircraft is stalled. Ignoring it");
-      counter--;
-      index = counter - 1;
-    }
+      break;
+    case VrsKey::AcList:
+    case VrsKey::LastDv:
+    case VrsKey::Stm:
+    case VrsKey::Unknown:
+      break;
   }
 
 }
 
 Aircraft AdsbExchangeClient::getAircraft(int i) {
-  if (i < MAX_AIRCRAFTS) {
-    return aircrafts[i];
-  }
-  //return nullptr;
+  return store->getAircraft(i);
 }
 
-AircraftHistory AdsbExchangeClient::getAircraftHistory(int i) {
-  return histories[i];
+Aircraft AdsbExchangeClient::getAircraft(int i, unsigned long now) {
+  return store->getAircraft(i, now);
 }
 
-int AdsbExchangeClient::getNumberOfAircrafts() {
-  return counter;
+const AircraftHistory* AdsbExchangeClient::getAircraftHistory(int i) {
+  return store->getAircraftHistory(i);
 }
 
-Aircraft AdsbExchangeClient::getClosestAircraft(double lat, double lon) {
-  double minDistance = 999999.0;
-  Aircraft closestAircraft = aircrafts[0];
-  for (int i = 0; i < getNumberOfAircrafts(); i++) {
-    Aircraft currentAircraft = aircrafts[i];
+int AdsbExchangeClient::getNumberOfAircrafts() {
+  return store->getNumberOfAircrafts();
+}
 
-    if (currentAircraft.distance < minDistance) {
-      minDistance = currentAircraft.distance;
-      closestAircraft = currentAircraft;
-    }
-  }
-  return closestAircraft;
+int AdsbExchangeClient::findClosestAircraft() {
+  return store->findClosest();
 }
 
-void AdsbExchangeClient::endArray() {
-  if (counter >= MAX_AIRCRAFTS - 1) {
-    Serial.println("Max Aircrafts reached:end array");
+void AdsbExchangeClient::identifyAircraft(uint32_t icao) {
+  if (current.icao == icao) {
     return;
   }
-  if (currentKey == "Cos" && trailIndex > 0) {
-    AircraftHistory history = {};
-    uint16_t items = (trailIndex / 4);
-    Serial.println("Finished history array: " + String(items) + " elements");
-    int historyCounter = 0;
-    for (int i = 0; i < min(items, MAX_HISTORY); i++) {
-      AircraftPosition position = {};
-      Coordinates coordinates = position.coordinates;
-      coordinates.lat = positionTemp[items - i - 1].coordinates.lat;
-      coordinates.lon = positionTemp[items - i - 1].coordinates.lon;
-      position.coordinates = coordinates;
-      position.altitude = positionTemp[items - i - 1].altitude;
-      history.positions[i] = position;
-      //Serial.println(String(i) + ": " + String(items - i -1) + ", " + String(history.positions[i].coordinates.lat, 9) + ", " + String(history.positions[i].coordinates.lon, 9));
-      historyCounter++;
-    }
-    history.call = aircrafts[index].call;
-    history.counter = historyCounter;
-    histories[index] = history;
-    currentKey = "";
+  boolean first = current.icao == 0;
+  current.icao = icao;
+  int i = store->find(icao);
+  if (i >= 0 && first && deltaUpdate) {
+    // A delta only lists the values that changed, start from the known ones
+    StringPool* strings = store->getStringPool();
+    releaseStrings();
+    current = store->getRecord(i);
+    strings->retain(current.from);
+    strings->retain(current.to);
+    strings->retain(current.model);
+    strings->retain(current.operatorCode);
   }
 }
 
-void AdsbExchangeClient::endObject() {
-
+void AdsbExchangeClient::commitAircraft() {
+  if (current.icao == 0) {
+    releaseStrings();
+    return;
+  }
+  if (!partialUpdate) {
+    fetchStats.aircraft++;
+  }
+  if (currentPosStale) {
+    fetchStats.droppedAircraft++;
+    releaseStrings();
+    return;
+  }
+  if (deltaUpdate && (currentFields & AIRCRAFT_ALL_FIELDS) != AIRCRAFT_ALL_FIELDS && store->find(current.icao) < 0) {
+    // Only the changes of an aircraft the store dropped, stalled or out of
+    // room. The next poll asks for the full list to get it back.
+    fetchStats.droppedAircraft++;
+    missedAircraft = true;
+    releaseStrings();
+    return;
+  }
+  // VRS gives no time for the other fields, they are as old as the position
+  unsigned long now = millis();
+  unsigned long fixMillis = now;
+  if (currentPosTime > 0 && hasServerClock) {
+    fixMillis = currentPosTime - serverClockOffset;
+  }
+  if (merger->update(current, currentHasHistory ? &currentHistory : nullptr, currentFields, source,
+                     fixMillis, now) < 0) {
+    fetchStats.droppedAircraft++;
+  }
+  // The merger took over the references
+  current.from = current.to = current.model = current.operatorCode = NO_STRING;
 }
 
-void AdsbExchangeClient::endDocument() {
-  /*Serial.println("End of document:");
-  for (int i = 0; i < getNumberOfAircrafts(); i++) {
-    AircraftHistory history = histories[i];
-    for (int j = 0; j < history.counter; j++) {
-      AircraftPosition position = history.positions[j];
-      Serial.println(history.call + ": " + String(j) + ". " + String(position.coordinates.lat, 9) + ", " + String(position.coordinates.lon, 9) + ", " + String(position.altitude));
-    }
-  }*/
+void AdsbExchangeClient::releaseStrings() {
+  StringPool* strings = store->getStringPool();
+  strings->release(current.from);
+  strings->release(current.to);
+  strings->release(current.model);
+  strings->release(current.operatorCode);
+  current.from = current.to = current.model = current.operatorCode = NO_STRING;
 }
 
 void AdsbExchangeClient::startArray() {
+  depth++;
+  if (currentKey == VrsKey::AcList && acListDepth == 0) {
+    acListDepth = depth;
+  }
+}
 
+void AdsbExchangeClient::endArray() {
+  if (depth == acListDepth) {
+    acListDepth = 0;
+  }
+  depth--;
+  if (currentKey == VrsKey::Cos && trailIndex > 0) {
+    currentKey = VrsKey::Unknown;
+  }
 }
 
 void AdsbExchangeClient::startObject() {
+  depth++;
+  if (acListDepth > 0 && depth == acListDepth + 1) {
+    // Left over if the previous document ended inside an aircraft
+    releaseStrings();
+    current = {};
+    currentHistory.clear();
+    currentHasHistory = false;
+    currentPosStale = false;
+    currentFields = 0;
+    currentPosTime = 0;
+    trailIndex = 0;
+  }
+}
 
+void AdsbExchangeClient::endObject() {
+  if (acListDepth > 0 && depth == acListDepth + 1) {
+    commitAircraft();
+  }
+  depth--;
+}
+
+void AdsbExchangeClient::endDocument() {
+  if (!partialUpdate) {
+    // Only a complete list moves the data version on
+    strcpy(lastDv, missedAircraft ? "" : pendingDv);
+    merger->removeStale(millis());
+  }
 }
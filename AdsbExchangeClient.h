@@ -26,84 +26,223 @@ See more at http://blog.squix.ch
 #pragma once
 
 #include <Arduino.h>
-#include <JsonListener.h>
-#include <JsonStreamingParser.h>
 #include <ESP8266WiFi.h>
 #include <WiFiClient.h>
+#include "JsonTokenizer.h"
+#include "HttpResponseParser.h"
+#include "Inflater.h"
 #include "GeoMap.h"
 
-#define MAX_AIRCRAFTS 10
-#define MAX_HISTORY 20
-#define MAX_HISTORY_TEMP 80
+#include "FeedMerger.h"
+#include "Metrics.h"
+
+// Aircraft whose full trail is requested after a poll, at most. The others
+// get theirs in the following polls.
+#define MAX_TRAIL_REQUESTS 2
+
+// Room for the lastDv data version, a decimal number of 18 digits
+#define DATA_VERSION_LENGTH 24
 
-#define MAX_AGE_MILLIS 15000
 #define min(a,b) ((a)<(b)?(a):(b))
 
-struct AircraftPosition {
-  int altitude;
-  Coordinates coordinates;
+// Keys of the VirtualRadar aircraft objects the client reads. Everything
+// else in the feed maps to Unknown and is ignored.
+enum class VrsKey : uint8_t {
+  Unknown,
+  AcList,
+  LastDv,
+  Id,
+  From,
+  To,
+  OpIcao,
+  Dst,
+  Mdl,
+  Trak,
+  Alt,
+  Lat,
+  Long,
+  Spd,
+  Sqk,
+  Icao,
+  Call,
+  PosStale,
+  Cos,
+  PosTime,
+  Stm
 };
 
-struct AircraftHistory {
-  String call;
-  AircraftPosition positions[MAX_HISTORY];
-  int counter;
+// Time one update spent on the network
+struct FetchStats {
+  // Whether the aircraft list was read to its end
+  boolean complete;
+  uint8_t requests;
+  uint8_t connects;
+  uint32_t connectMicros;
+  // Bytes read from the socket and JSON bytes they held, which differ when
+  // the server compressed the answer
+  uint32_t receivedBytes;
+  uint32_t documentBytes;
+  // From sending a request to the end of its response, parsing included,
+  // and the part of it until the first byte came
+  uint32_t transferMicros;
+  uint32_t firstByteMicros;
+  // Spent in the inflater and the JSON parser
+  uint32_t parseMicros;
+  // Aircraft in the list, and those not stored because they were stalled or
+  // the store was full
+  uint16_t aircraft;
+  uint16_t droppedAircraft;
 };
 
-struct Aircraft {
-    String from;
-    String fromCode;
-    String fromShort;
-    String to;
-    String toCode;
-    String toShort;
-    double speed;
-    double lat;
-    double lon;
-    uint16_t altitude;
-    double distance;
-    String aircraftType;
-    String operatorCode;
-    double heading;
-    String icao;
-    String call;
-    boolean posStall;
+// Steps of a request. Each poll() call does the work of the current step
+// that can be done without waiting.
+enum class FetchState : uint8_t {
+  Idle,
+  Connect,
+  Send,
+  Headers,
+  Body
 };
 
-
-
-
-class AdsbExchangeClient: public JsonListener {
+class AdsbExchangeClient: public JsonSpanListener {
   private:
-    int counter = 0;
-    int index = 0;
-    String currentKey = "";
-    Aircraft aircrafts[MAX_AIRCRAFTS];
-    AircraftHistory histories[MAX_AIRCRAFTS];
-    AircraftPosition positionTemp[MAX_HISTORY_TEMP];
-    long lastSightingMillis = 0;
+    FeedMerger* merger;
+    AircraftStore* store;
+    uint8_t source;
+    WiFiClient client;
+    JsonTokenizer parser;
+    HttpResponseParser response;
+    // Allocated with the first compressed answer, so a client that never gets
+    // one doesn't pay for the window
+    Inflater* inflater = nullptr;
+    boolean compression = false;
+    boolean inflating = false;
+    FetchState fetchState = FetchState::Idle;
+    // millis() when the current state was entered or data last arrived
+    unsigned long fetchMillis = 0;
+    unsigned long transferStartMicros = 0;
+    // micros() when the first byte of the answer came, 0 before
+    unsigned long firstByteMicros = 0;
+    // Set while a kept connection has not answered the request yet. If it
+    // turns out to be closed, the request is sent on a new one.
+    boolean reusedConnection = false;
+    FetchStats fetchStats = {};
+    FetchStats lastFetchStats = {};
+    String requestQuery;
+    // The query of the update without ldv. Trail requests keep its location,
+    // VRS only sends Dst for a query with lat and lng.
+    String updateQuery;
+    // Aircraft whose trail is requested once the list is in
+    uint32_t trailIcaos[MAX_TRAIL_REQUESTS];
+    int trailRequests = 0;
+    int nextTrailRequest = 0;
+    // Set while reading the trail of single aircraft, which must not age
+    // out the others
+    boolean partialUpdate = false;
+    // Data version of the last complete list. It is sent back as ldv, and
+    // the server then only lists what changed since.
+    char lastDv[DATA_VERSION_LENGTH] = "";
+    char pendingDv[DATA_VERSION_LENGTH] = "";
+    boolean deltaUpdate = false;
+    // Set if the delta listed an aircraft the store doesn't hold without all
+    // its fields
+    boolean missedAircraft = false;
+    // StringPool overflows already reported, they are printed once per update
+    uint16_t stringOverflows = 0;
+    VrsKey currentKey = VrsKey::Unknown;
+    // Nesting level of the parser and of the acList array, 0 if outside
+    int depth = 0;
+    int acListDepth = 0;
+    // The aircraft being parsed, committed to the store at its end
+    AircraftRecord current;
+    AircraftHistory currentHistory;
+    boolean currentHasHistory = false;
+    boolean currentPosStale = false;
+    // Groups of fields the aircraft object set, and the server time of its
+    // position in ms since 1970, 0 if not given
+    uint8_t currentFields = 0;
+    int64_t currentPosTime = 0;
+    // Server time minus millis() when the last document ended. VRS sends
+    // stm after the aircraft, so their PosTime is mapped with the offset of
+    // the previous document.
+    int64_t serverClockOffset = 0;
+    boolean hasServerClock = false;
+    // Position of the Cos quad [lat, lon, time, altitude] being read
+    int32_t trailLat = 0;
+    int32_t trailLon = 0;
     int trailIndex = 0;
 
+    void startRequest(String query);
+    void readResponse();
+    void parseBody(const char* data, size_t length, HttpEncoding encoding);
+    void finishRequest();
+    void recordMetrics();
+    void identifyAircraft(uint32_t icao);
+    void commitAircraft();
+    void releaseStrings();
+
   public:
-    AdsbExchangeClient();
+    // Puts the aircraft into the merger as source "ADSBx"
+    AdsbExchangeClient(FeedMerger* merger);
+
+    ~AdsbExchangeClient();
+
+    static VrsKey lookupKey(const char* key, size_t length);
+
+    // Starts fetching the aircraft for the query, poll() does the work.
+    // Without trFmt in the query, trails are built from the positions of each
+    // poll, and the full trail of a new aircraft is requested once. After the
+    // first poll only the changes since the previous one are fetched. An
+    // update still running is abandoned.
+    void startUpdate(String searchQuery);
 
+    // Advances the update without waiting for the network: connects, sends
+    // the request or parses what has arrived. Returns true while the update
+    // is still running. The store is updated while the answer is parsed.
+    boolean poll();
+
+    boolean isUpdating();
+
+    // The id the aircraft of this client have in the merger
+    uint8_t getSource();
+
+    // Connects and transfer time of the last finished update. The client
+    // keeps its connection between requests if the server allows it.
+    FetchStats getLastFetchStats();
+
+    // Asks the server for gzip or deflate compressed answers, off by default.
+    // Only turn it on for a server known to compress with a window of at most
+    // INFLATE_WINDOW_SIZE bytes. If the server refers back further, the
+    // client turns it off and asks again.
+    void setCompression(boolean enabled);
+
+    // startUpdate() and poll() until done
     void updateVisibleAircraft(String searchQuery);
 
+    // Parses a recorded answer body into the store like poll() does, in
+    // pieces the size of its socket reads and through the inflater unless
+    // the encoding is Identity. For the host benchmarks.
+    void parseRecordedBody(const char* data, size_t length, HttpEncoding encoding);
+
     Aircraft getAircraft(int i);
 
-    AircraftHistory getAircraftHistory(int i);
+    // The aircraft at its extrapolated position, see AircraftStore
+    Aircraft getAircraft(int i, unsigned long now);
+
+    // Null if the aircraft has no trail
+    const AircraftHistory* getAircraftHistory(int i);
     
     int getNumberOfAircrafts();
 
-    Aircraft getClosestAircraft(double lat, double lon);
-
-    virtual void whitespace(char c);
+    // Index of the aircraft closest to the lat/lng of the query, -1 if there
+    // are no aircraft
+    int findClosestAircraft();
 
     virtual void startDocument();
 
-    virtual void key(String key);
+    virtual bool key(const char* key, size_t length);
 
-    virtual void value(String value);
+    virtual void value(const char* value, size_t length, JsonValueType type);
 
     virtual void endArray();
 
@@ -0,0 +1,122 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "AircraftHistory.h"
+
+AircraftHistory::AircraftHistory() {
+  clear();
+}
+
+void AircraftHistory::clear() {
+  head_ = 0;
+  steps_ = 0;
+  empty_ = true;
+}
+
+static int32_t roundToResolution(int32_t microDegrees) {
+  int32_t half = microDegrees < 0 ? -TRAIL_RESOLUTION / 2 : TRAIL_RESOLUTION / 2;
+  return (microDegrees + half) / TRAIL_RESOLUTION * TRAIL_RESOLUTION;
+}
+
+void AircraftHistory::append(int32_t lat, int32_t lon, uint16_t altitude) {
+  lat = roundToResolution(lat);
+  lon = roundToResolution(lon);
+  uint16_t steps = (altitude + TRAIL_ALTITUDE_STEP / 2) / TRAIL_ALTITUDE_STEP;
+  uint8_t compactAltitude = steps > 255 ? 255 : steps;
+  if (empty_) {
+    lat_ = lat;
+    lon_ = lon;
+    altitude_ = compactAltitude;
+    empty_ = false;
+    return;
+  }
+  // One less than INT8_MAX leaves room for rounding the split points
+  const int32_t maxStep = INT8_MAX - 1;
+  int32_t latDistance = abs(lat_ - lat) / TRAIL_RESOLUTION;
+  int32_t lonDistance = abs(lon_ - lon) / TRAIL_RESOLUTION;
+  int32_t distance = latDistance > lonDistance ? latDistance : lonDistance;
+  if (distance == 0) {
+    altitude_ = compactAltitude;
+    return;
+  }
+  int32_t parts = (distance + maxStep - 1) / maxStep;
+  if (parts > TRAIL_LENGTH / 4) {
+    // The aircraft was gone for a long time, don't connect the pieces
+    clear();
+    append(lat, lon, altitude);
+    return;
+  }
+  int32_t startLat = lat_;
+  int32_t startLon = lon_;
+  for (int32_t part = 1; part < parts; part++) {
+    appendStep(roundToResolution(startLat + (lat - startLat) / parts * part),
+               roundToResolution(startLon + (lon - startLon) / parts * part), altitude_);
+  }
+  appendStep(lat, lon, compactAltitude);
+}
+
+// The current newest position becomes a step from the new one
+void AircraftHistory::appendStep(int32_t lat, int32_t lon, uint8_t altitude) {
+  latSteps_[head_] = (lat_ - lat) / TRAIL_RESOLUTION;
+  lonSteps_[head_] = (lon_ - lon) / TRAIL_RESOLUTION;
+  altitudes_[head_] = altitude_;
+  head_ = (head_ + 1) % TRAIL_LENGTH;
+  if (steps_ < TRAIL_LENGTH) {
+    steps_++;
+  }
+  lat_ = lat;
+  lon_ = lon;
+  altitude_ = altitude;
+}
+
+int AircraftHistory::getNumberOfPositions() const {
+  return empty_ ? 0 : steps_ + 1;
+}
+
+AircraftHistoryCursor AircraftHistory::begin() const {
+  AircraftHistoryCursor cursor;
+  cursor.lat = lat_;
+  cursor.lon = lon_;
+  cursor.index = 0;
+  return cursor;
+}
+
+boolean AircraftHistory::next(AircraftHistoryCursor& cursor, AircraftPosition& position) const {
+  if (cursor.index >= getNumberOfPositions()) {
+    return false;
+  }
+  uint8_t altitude = altitude_;
+  if (cursor.index > 0) {
+    int step = (head_ + TRAIL_LENGTH - cursor.index) % TRAIL_LENGTH;
+    cursor.lat += (int32_t) latSteps_[step] * TRAIL_RESOLUTION;
+    cursor.lon += (int32_t) lonSteps_[step] * TRAIL_RESOLUTION;
+    altitude = altitudes_[step];
+  }
+  position.coordinates.lat = cursor.lat / 1e6;
+  position.coordinates.lon = cursor.lon / 1e6;
+  position.altitude = altitude * TRAIL_ALTITUDE_STEP;
+  cursor.index++;
+  return true;
+}
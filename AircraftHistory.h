@@ -0,0 +1,92 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "GeoMap.h"
+
+// Positions kept per trail besides the newest one
+#define TRAIL_LENGTH 320
+// Trail positions are rounded to this many micro degrees (about 11 m, a
+// tenth of a pixel at zoom 10), which lets a step between two positions of
+// up to 0.0126 degrees (1.4 km) fit in an int8. Longer jumps take several
+// steps.
+#define TRAIL_RESOLUTION 100
+// Trail altitudes are kept in steps of this many feet
+#define TRAIL_ALTITUDE_STEP 250
+
+struct AircraftPosition {
+  int altitude;
+  Coordinates coordinates;
+};
+
+// Walks an AircraftHistory from the newest to the oldest position
+struct AircraftHistoryCursor {
+  int32_t lat;
+  int32_t lon;
+  int index;
+};
+
+// Trail of an aircraft as a ring buffer. The newest position is kept in full
+// and each older one as the int8 step from its newer neighbour, so a
+// position costs 3 bytes instead of 24 for an AircraftPosition. int16 steps
+// would cost 5 bytes; int8 ones round to 11 m and split jumps over 1.4 km,
+// neither of which shows on the map. When the ring is full, appending drops
+// the oldest position.
+class AircraftHistory {
+  private:
+    // Newest position in micro degrees, rounded to TRAIL_RESOLUTION
+    int32_t lat_;
+    int32_t lon_;
+    uint8_t altitude_;
+    // Steps in TRAIL_RESOLUTION units and altitudes of the older positions,
+    // the newest step is at head_ - 1
+    int8_t latSteps_[TRAIL_LENGTH];
+    int8_t lonSteps_[TRAIL_LENGTH];
+    uint8_t altitudes_[TRAIL_LENGTH];
+    uint16_t head_;
+    uint16_t steps_;
+    boolean empty_;
+
+    void appendStep(int32_t lat, int32_t lon, uint8_t altitude);
+
+  public:
+    AircraftHistory();
+
+    void clear();
+
+    // Adds a new newest position, lat and lon in micro degrees. A jump too
+    // long for one step is split into several.
+    void append(int32_t lat, int32_t lon, uint16_t altitude);
+
+    int getNumberOfPositions() const;
+
+    AircraftHistoryCursor begin() const;
+
+    // Returns the position at the cursor and moves it to the next older one,
+    // false once all positions have been returned
+    boolean next(AircraftHistoryCursor& cursor, AircraftPosition& position) const;
+};
@@ -0,0 +1,70 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "AircraftScore.h"
+#include "AircraftStore.h"
+
+uint16_t DistanceScore::score(const AircraftRecord& record) {
+  return UINT16_MAX - record.distance;
+}
+
+boolean PriorityScore::addToWatchlist(uint32_t icao) {
+  if (watchlistCount_ >= MAX_WATCHLIST) {
+    return false;
+  }
+  watchlist_[watchlistCount_++] = icao;
+  return true;
+}
+
+boolean PriorityScore::isWatched(uint32_t icao) {
+  for (int i = 0; i < watchlistCount_; i++) {
+    if (watchlist_[i] == icao) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 7500 hijack, 7600 radio failure, 7700 general emergency
+boolean PriorityScore::isEmergency(uint16_t squawk) {
+  return squawk == 7500 || squawk == 7600 || squawk == 7700;
+}
+
+// The group goes into the top two bits, the distance in 40 m steps below
+uint16_t PriorityScore::score(const AircraftRecord& record) {
+  uint16_t group = 0;
+  if (isEmergency(record.squawk)) {
+    group = 3;
+  } else if (isWatched(record.icao)) {
+    group = 2;
+  } else if (record.altitude > 0 && record.altitude < LOW_ALTITUDE_FEET) {
+    group = 1;
+  }
+  uint16_t distance = record.distance / 4;
+  if (distance > 0x3FFF) {
+    distance = 0x3FFF;
+  }
+  return (group << 14) | (0x3FFF - distance);
+}
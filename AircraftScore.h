@@ -0,0 +1,69 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+struct AircraftRecord;
+
+#define MAX_WATCHLIST 8
+// Aircraft below this altitude rank above the others in PriorityScore
+#define LOW_ALTITUDE_FEET 5000
+
+// Decides which aircraft AircraftStore keeps once it is full: a new aircraft
+// only gets in if it scores higher than the lowest scored one in the store,
+// which is then dropped.
+class AircraftScore {
+  public:
+    virtual ~AircraftScore() {}
+
+    // Higher is more relevant
+    virtual uint16_t score(const AircraftRecord& record) = 0;
+};
+
+// Keeps the closest aircraft
+class DistanceScore: public AircraftScore {
+  public:
+    virtual uint16_t score(const AircraftRecord& record);
+};
+
+// Ranks aircraft squawking an emergency first, then watchlisted ones, then
+// those below LOW_ALTITUDE_FEET, and by distance within each group.
+class PriorityScore: public AircraftScore {
+  private:
+    uint32_t watchlist_[MAX_WATCHLIST];
+    int watchlistCount_ = 0;
+
+  public:
+    // Returns false if the watchlist is full
+    boolean addToWatchlist(uint32_t icao);
+
+    boolean isWatched(uint32_t icao);
+
+    static boolean isEmergency(uint16_t squawk);
+
+    virtual uint16_t score(const AircraftRecord& record);
+};
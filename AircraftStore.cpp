@@ -0,0 +1,487 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "AircraftStore.h"
+
+AircraftStore::AircraftStore(StringPool* strings) {
+  strings_ = strings;
+  score_ = &distanceScore_;
+  static_assert(sizeof(icaos_) + sizeof(lastSeen_) + sizeof(lats_) + sizeof(lons_) + sizeof(altitudes_)
+      + sizeof(speeds_) + sizeof(headings_) + sizeof(distances_) + sizeof(froms_) + sizeof(tos_)
+      + sizeof(models_) + sizeof(operators_) + sizeof(squawks_) + sizeof(scores_) + sizeof(fixTimes_)
+      + sizeof(fieldTimes_) + sizeof(sources_)
+      + sizeof(latOffsets_) + sizeof(lonOffsets_) + sizeof(latVelocities_) + sizeof(lonVelocities_)
+      + sizeof(latCorrections_) + sizeof(lonCorrections_) + sizeof(calls_) + sizeof(trails_)
+      + sizeof(heap_) + sizeof(heapPositions_)
+      == MAX_AIRCRAFTS * AIRCRAFT_RECORD_BYTES, "AIRCRAFT_RECORD_BYTES does not match the record arrays");
+  static_assert(MAX_AIRCRAFTS <= 255, "heap positions are 8 bit");
+  static_assert(MAX_POOL_STRINGS * 2 >= MAX_AIRCRAFTS * 5 && STRING_POOL_SIZE >= MAX_AIRCRAFTS * 32,
+      "the string pool is too small for the aircraft");
+  for (int i = 0; i < MAX_TRAILS; i++) {
+    trailUsed_[i] = false;
+  }
+}
+
+// Gives the aircraft a free trail slot, or the one of the lowest scored
+// aircraft holding a slot if it scores TRAIL_SCORE_MARGIN higher
+void AircraftStore::assignTrail(int i) {
+  if (trails_[i] != NO_TRAIL) {
+    return;
+  }
+  int slot = -1;
+  int lowest = -1;
+  for (int s = 0; s < MAX_TRAILS; s++) {
+    if (!trailUsed_[s]) {
+      slot = s;
+      break;
+    }
+    if (lowest < 0 || scores_[trailOwners_[s]] < scores_[trailOwners_[lowest]]) {
+      lowest = s;
+    }
+  }
+  if (slot < 0) {
+    if ((uint32_t) scores_[i] <= (uint32_t) scores_[trailOwners_[lowest]] + TRAIL_SCORE_MARGIN) {
+      return;
+    }
+    slot = lowest;
+    trails_[trailOwners_[slot]] = NO_TRAIL;
+  }
+  trailUsed_[slot] = true;
+  trailLoaded_[slot] = false;
+  trailOwners_[slot] = i;
+  histories_[slot].clear();
+  trails_[i] = slot;
+}
+
+void AircraftStore::setScore(AircraftScore* score) {
+  score_ = score;
+}
+
+int AircraftStore::update(const AircraftRecord& record, const AircraftHistory* history, unsigned long now,
+                          uint8_t fields, uint8_t source, unsigned long fixMillis) {
+  int i = find(record.icao);
+  uint16_t score = score_->score(record);
+  if (i < 0) {
+    if (isFull()) {
+      if (score <= scores_[heap_[0]]) {
+        return -1;
+      }
+      remove(heap_[0]);
+    }
+    i = count_++;
+    icaos_[i] = record.icao;
+    trails_[i] = NO_TRAIL;
+    scores_[i] = score;
+    heap_[i] = i;
+    heapPositions_[i] = i;
+    heapUp(i);
+    resetTrack(i, record, now);
+    distances_[i] = record.distance;
+    for (int field = 0; field < AIRCRAFT_FIELD_GROUPS; field++) {
+      fieldTimes_[i][field] = fixMillis - 86400000UL;
+    }
+    sources_[i] = source;
+  } else {
+    releaseStrings(i);
+    if (lats_[i] != record.lat || lons_[i] != record.lon) {
+      // The distance belongs to the position, keep both of an outlier
+      if (trackFix(i, record, now)) {
+        distances_[i] = record.distance;
+      } else {
+        fields &= ~AIRCRAFT_POSITION;
+      }
+    }
+  }
+  lastSeen_[i] = now / 1000;
+  for (int field = 0; field < AIRCRAFT_FIELD_GROUPS; field++) {
+    if (fields & (1 << field)) {
+      fieldTimes_[i][field] = fixMillis;
+    }
+  }
+  if (fields & AIRCRAFT_POSITION) {
+    sources_[i] = source;
+  }
+  altitudes_[i] = record.altitude;
+  speeds_[i] = record.speed;
+  headings_[i] = record.heading;
+  froms_[i] = record.from;
+  tos_[i] = record.to;
+  models_[i] = record.model;
+  operators_[i] = record.operatorCode;
+  squawks_[i] = record.squawk;
+  memcpy(calls_[i], record.call, AIRCRAFT_CALL_LENGTH);
+  if (scores_[i] != score) {
+    uint16_t previous = scores_[i];
+    scores_[i] = score;
+    if (score < previous) {
+      heapUp(heapPositions_[i]);
+    } else {
+      heapDown(heapPositions_[i]);
+    }
+  }
+  assignTrail(i);
+  if (trails_[i] != NO_TRAIL) {
+    if (history) {
+      histories_[trails_[i]] = *history;
+      trailLoaded_[trails_[i]] = true;
+    } else {
+      // The filtered position, so the trail does not show the jitter
+      histories_[trails_[i]].append(lats_[i] + latOffsets_[i], lons_[i] + lonOffsets_[i], record.altitude);
+    }
+  }
+  return i;
+}
+
+void AircraftStore::removeStale(unsigned long now) {
+  uint16_t nowSeconds = now / 1000;
+  int i = 0;
+  while (i < count_) {
+    uint16_t age = nowSeconds - lastSeen_[i];
+    if (age * 1000UL > MAX_AGE_MILLIS) {
+      remove(i);
+    } else {
+      i++;
+    }
+  }
+}
+
+void AircraftStore::heapSwap(int a, int b) {
+  uint8_t aircraft = heap_[a];
+  heap_[a] = heap_[b];
+  heap_[b] = aircraft;
+  heapPositions_[heap_[a]] = a;
+  heapPositions_[heap_[b]] = b;
+}
+
+void AircraftStore::heapUp(int position) {
+  while (position > 0) {
+    int parent = (position - 1) / 2;
+    if (scores_[heap_[parent]] <= scores_[heap_[position]]) {
+      break;
+    }
+    heapSwap(parent, position);
+    position = parent;
+  }
+}
+
+void AircraftStore::heapDown(int position) {
+  while (true) {
+    int smallest = position;
+    int left = 2 * position + 1;
+    int right = left + 1;
+    if (left < count_ && scores_[heap_[left]] < scores_[heap_[smallest]]) {
+      smallest = left;
+    }
+    if (right < count_ && scores_[heap_[right]] < scores_[heap_[smallest]]) {
+      smallest = right;
+    }
+    if (smallest == position) {
+      break;
+    }
+    heapSwap(smallest, position);
+    position = smallest;
+  }
+}
+
+// Called before count_ goes down, the heap has count_ entries
+void AircraftStore::heapRemove(int position) {
+  int last = count_ - 1;
+  if (position != last) {
+    heapSwap(position, last);
+    // count_ still includes the removed entry, keep it out of the way
+    count_--;
+    heapUp(position);
+    heapDown(position);
+    count_++;
+  }
+}
+
+// Moves the last aircraft into the gap so the table stays dense
+void AircraftStore::remove(int i) {
+  releaseStrings(i);
+  if (trails_[i] != NO_TRAIL) {
+    trailUsed_[trails_[i]] = false;
+  }
+  heapRemove(heapPositions_[i]);
+  count_--;
+  if (i != count_) {
+    icaos_[i] = icaos_[count_];
+    lastSeen_[i] = lastSeen_[count_];
+    lats_[i] = lats_[count_];
+    lons_[i] = lons_[count_];
+    altitudes_[i] = altitudes_[count_];
+    speeds_[i] = speeds_[count_];
+    headings_[i] = headings_[count_];
+    distances_[i] = distances_[count_];
+    froms_[i] = froms_[count_];
+    tos_[i] = tos_[count_];
+    models_[i] = models_[count_];
+    operators_[i] = operators_[count_];
+    squawks_[i] = squawks_[count_];
+    scores_[i] = scores_[count_];
+    fixTimes_[i] = fixTimes_[count_];
+    memcpy(fieldTimes_[i], fieldTimes_[count_], sizeof(fieldTimes_[i]));
+    sources_[i] = sources_[count_];
+    latOffsets_[i] = latOffsets_[count_];
+    lonOffsets_[i] = lonOffsets_[count_];
+    latVelocities_[i] = latVelocities_[count_];
+    lonVelocities_[i] = lonVelocities_[count_];
+    latCorrections_[i] = latCorrections_[count_];
+    lonCorrections_[i] = lonCorrections_[count_];
+    memcpy(calls_[i], calls_[count_], AIRCRAFT_CALL_LENGTH);
+    trails_[i] = trails_[count_];
+    if (trails_[i] != NO_TRAIL) {
+      trailOwners_[trails_[i]] = i;
+    }
+    heapPositions_[i] = heapPositions_[count_];
+    heap_[heapPositions_[i]] = i;
+  }
+}
+
+void AircraftStore::releaseStrings(int i) {
+  strings_->release(froms_[i]);
+  strings_->release(tos_[i]);
+  strings_->release(models_[i]);
+  strings_->release(operators_[i]);
+}
+
+int AircraftStore::find(uint32_t icao) {
+  for (int i = 0; i < count_; i++) {
+    if (icaos_[i] == icao) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+boolean AircraftStore::isFull() {
+  return count_ >= MAX_AIRCRAFTS;
+}
+
+int AircraftStore::getNumberOfAircrafts() {
+  return count_;
+}
+
+AircraftRecord AircraftStore::getRecord(int i) {
+  AircraftRecord record;
+  record.icao = icaos_[i];
+  record.lat = lats_[i];
+  record.lon = lons_[i];
+  record.altitude = altitudes_[i];
+  record.speed = speeds_[i];
+  record.heading = headings_[i];
+  record.distance = distances_[i];
+  record.from = froms_[i];
+  record.to = tos_[i];
+  record.model = models_[i];
+  record.operatorCode = operators_[i];
+  record.squawk = squawks_[i];
+  memcpy(record.call, calls_[i], AIRCRAFT_CALL_LENGTH);
+  return record;
+}
+
+unsigned long AircraftStore::getFieldTime(int i, uint8_t field) {
+  int group = 0;
+  while (field > 1) {
+    field >>= 1;
+    group++;
+  }
+  return fieldTimes_[i][group];
+}
+
+uint8_t AircraftStore::getSource(int i) {
+  return sources_[i];
+}
+
+Aircraft AircraftStore::getAircraft(int i) {
+  Aircraft aircraft;
+  aircraft.icao = icaos_[i];
+  memcpy(aircraft.call, calls_[i], AIRCRAFT_CALL_LENGTH);
+  aircraft.call[AIRCRAFT_CALL_LENGTH] = '\0';
+  aircraft.speed = speeds_[i];
+  aircraft.lat = (lats_[i] + latOffsets_[i]) / 1e6;
+  aircraft.lon = (lons_[i] + lonOffsets_[i]) / 1e6;
+  aircraft.altitude = altitudes_[i];
+  aircraft.distance = distances_[i] / 100.0;
+  aircraft.heading = headings_[i] / 10.0;
+  aircraft.from = froms_[i];
+  aircraft.to = tos_[i];
+  aircraft.aircraftType = models_[i];
+  aircraft.operatorCode = operators_[i];
+  aircraft.squawk = squawks_[i];
+  aircraft.source = sources_[i];
+  return aircraft;
+}
+
+Aircraft AircraftStore::getAircraft(int i, unsigned long now) {
+  Aircraft aircraft = getAircraft(i);
+  int32_t lat;
+  int32_t lon;
+  extrapolate(i, now, lat, lon);
+  aircraft.lat = lat / 1e6;
+  aircraft.lon = lon / 1e6;
+  return aircraft;
+}
+
+static int16_t clampToInt16(int32_t value) {
+  return value < INT16_MIN ? INT16_MIN : (value > INT16_MAX ? INT16_MAX : value);
+}
+
+// Degrees of longitude get shorter towards the poles
+static float lonScale(int32_t lat) {
+  float scale = cos(lat * (float) PI / 180e6f);
+  return scale < 0.01f ? 0.01f : scale;
+}
+
+void AircraftStore::extrapolate(int i, unsigned long now, int32_t& lat, int32_t& lon) {
+  unsigned long age = now - fixTimes_[i];
+  int32_t movingTime = age < MAX_EXTRAPOLATION_MILLIS ? age : MAX_EXTRAPOLATION_MILLIS;
+  lat = lats_[i] + latOffsets_[i] + latVelocities_[i] * movingTime / 1000;
+  lon = lons_[i] + lonOffsets_[i] + lonVelocities_[i] * movingTime / 1000;
+  if (age < CORRECTION_MILLIS) {
+    int32_t remaining = CORRECTION_MILLIS - age;
+    lat += latCorrections_[i] * CORRECTION_RESOLUTION * remaining / CORRECTION_MILLIS;
+    lon += lonCorrections_[i] * CORRECTION_RESOLUTION * remaining / CORRECTION_MILLIS;
+  }
+}
+
+// Restarts the filter at the reported position with the velocity the feed
+// reports. One knot is 1e6 / 3600 / 60 micro degrees of latitude per second.
+void AircraftStore::resetTrack(int i, const AircraftRecord& record, unsigned long now) {
+  float speed = record.speed * (1e6f / 3600 / 60);
+  float heading = record.heading * (float) PI / 1800;
+  lats_[i] = record.lat;
+  lons_[i] = record.lon;
+  latOffsets_[i] = 0;
+  lonOffsets_[i] = 0;
+  latVelocities_[i] = clampToInt16(speed * cos(heading));
+  lonVelocities_[i] = clampToInt16(speed * sin(heading) / lonScale(record.lat));
+  latCorrections_[i] = 0;
+  lonCorrections_[i] = 0;
+  fixTimes_[i] = now;
+}
+
+// One alpha-beta step: the estimate moves from the predicted position part
+// of the way to the fix, and the velocity is nudged by the rest. Returns
+// false if the fix is rejected as an outlier. Rejected fixes keep coming
+// with each poll while the feed reports them, and the outlier gate grows
+// with the time since the last accepted fix until one fits.
+boolean AircraftStore::trackFix(int i, const AircraftRecord& record, unsigned long now) {
+  int32_t shownLat;
+  int32_t shownLon;
+  extrapolate(i, now, shownLat, shownLon);
+  unsigned long age = now - fixTimes_[i];
+  if (age > MAX_EXTRAPOLATION_MILLIS) {
+    resetTrack(i, record, now);
+  } else {
+    int32_t predictedLat = lats_[i] + latOffsets_[i] + latVelocities_[i] * (int32_t) age / 1000;
+    int32_t predictedLon = lons_[i] + lonOffsets_[i] + lonVelocities_[i] * (int32_t) age / 1000;
+    int32_t latResidual = record.lat - predictedLat;
+    int32_t lonResidual = record.lon - predictedLon;
+    int32_t gate = OUTLIER_MARGIN + OUTLIER_SPEED * (int32_t) age / 1000;
+    if (abs(latResidual) > gate || abs(lonResidual) * lonScale(record.lat) > gate) {
+      return false;
+    }
+    int32_t latOffset = predictedLat + latResidual * FILTER_ALPHA / 256 - record.lat;
+    int32_t lonOffset = predictedLon + lonResidual * FILTER_ALPHA / 256 - record.lon;
+    if (latOffset < INT16_MIN || latOffset > INT16_MAX || lonOffset < INT16_MIN || lonOffset > INT16_MAX) {
+      resetTrack(i, record, now);
+    } else {
+      if (age >= FILTER_MIN_MILLIS) {
+        latVelocities_[i] = clampToInt16(latVelocities_[i] + latResidual * FILTER_BETA / 256 * 1000 / (int32_t) age);
+        lonVelocities_[i] = clampToInt16(lonVelocities_[i] + lonResidual * FILTER_BETA / 256 * 1000 / (int32_t) age);
+      }
+      lats_[i] = record.lat;
+      lons_[i] = record.lon;
+      latOffsets_[i] = latOffset;
+      lonOffsets_[i] = lonOffset;
+      fixTimes_[i] = now;
+    }
+  }
+  startCorrection(i, shownLat, shownLon);
+  return true;
+}
+
+// Lets the shown position glide from where the aircraft was drawn onto the
+// new estimate. Gaps that don't fit the corrections are not smoothed, the
+// aircraft jumps instead.
+void AircraftStore::startCorrection(int i, int32_t shownLat, int32_t shownLon) {
+  int32_t latCorrection = (shownLat - lats_[i] - latOffsets_[i]) / CORRECTION_RESOLUTION;
+  int32_t lonCorrection = (shownLon - lons_[i] - lonOffsets_[i]) / CORRECTION_RESOLUTION;
+  if (latCorrection < INT16_MIN || latCorrection > INT16_MAX || lonCorrection < INT16_MIN || lonCorrection > INT16_MAX) {
+    latCorrection = lonCorrection = 0;
+  }
+  latCorrections_[i] = latCorrection;
+  lonCorrections_[i] = lonCorrection;
+}
+
+const AircraftHistory* AircraftStore::getAircraftHistory(int i) {
+  if (trails_[i] == NO_TRAIL) {
+    return nullptr;
+  }
+  return &histories_[trails_[i]];
+}
+
+int AircraftStore::findClosest() {
+  int closest = -1;
+  for (int i = 0; i < count_; i++) {
+    if (closest < 0 || distances_[i] < distances_[closest]) {
+      closest = i;
+    }
+  }
+  return closest;
+}
+
+uint32_t AircraftStore::getIcao(int i) {
+  return icaos_[i];
+}
+
+boolean AircraftStore::needsTrail(int i) {
+  return trails_[i] != NO_TRAIL && !trailLoaded_[trails_[i]];
+}
+
+void AircraftStore::setTrailLoaded(int i) {
+  if (trails_[i] != NO_TRAIL) {
+    trailLoaded_[trails_[i]] = true;
+  }
+}
+
+StringPool* AircraftStore::getStringPool() {
+  return strings_;
+}
+
+void AircraftStore::printMemoryReport(int otherBytes) {
+  Serial.println("Aircraft store memory:");
+  Serial.println("  records: " + String(MAX_AIRCRAFTS) + " aircraft x " + String(AIRCRAFT_RECORD_BYTES)
+      + " bytes = " + String(MAX_AIRCRAFTS * AIRCRAFT_RECORD_BYTES) + " bytes (budget " + String(AIRCRAFT_RAM_BUDGET) + ")");
+  Serial.println("  trails: " + String(MAX_TRAILS) + " x " + String((int) sizeof(AircraftHistory)) + " bytes = "
+      + String((int) sizeof(histories_)) + " bytes, up to " + String(TRAIL_LENGTH + 1) + " positions each");
+  Serial.println("  strings: " + String((int) sizeof(StringPool)) + " bytes, " + String(strings_->getUsedBytes())
+      + " used by " + String(strings_->getNumberOfStrings()) + " strings, " + String(strings_->getNumberOfEvictions())
+      + " evicted, " + String(strings_->getNumberOfOverflows()) + " dropped");
+  int storeBytes = sizeof(AircraftStore) + sizeof(StringPool);
+  Serial.println("  store and strings: " + String(storeBytes) + " bytes");
+  Serial.println("  total with clients, display and metrics: " + String(storeBytes + otherBytes) + " bytes");
+}
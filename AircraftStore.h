@@ -0,0 +1,288 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "AircraftHistory.h"
+#include "AircraftScore.h"
+#include "StringPool.h"
+
+// RAM set aside for the aircraft records. The number of aircraft the store
+// can track follows from it. The records are only part of the static RAM:
+// with the trails and the string pool the store takes about 20 KB, the
+// clients, display and metrics about 3.5 KB more. printMemoryReport() prints
+// the actual sizes and the total.
+#define AIRCRAFT_RAM_BUDGET 8364
+// Bytes one aircraft takes in the arrays of AircraftStore
+#define AIRCRAFT_RECORD_BYTES 82
+#define MAX_AIRCRAFTS (AIRCRAFT_RAM_BUDGET / AIRCRAFT_RECORD_BYTES)
+
+#define AIRCRAFT_CALL_LENGTH 8
+
+// Trails are kept for this many aircraft, the highest scored ones. A trail
+// of TRAIL_LENGTH 320 takes 976 bytes, so 6 take 5856 bytes. This trades
+// trails for length: 10 trails of 320 positions would take 9760 bytes with
+// the int8 steps of AircraftHistory and 16 KB with int16 steps.
+#define MAX_TRAILS 6
+#define NO_TRAIL 0xFF
+// An aircraft without a trail takes the slot of the lowest scored one that
+// has a trail once it scores this much higher, 1 km for DistanceScore. Keeps
+// two aircraft at about the same distance from trading the slot, which
+// clears the trail, on every update.
+#define TRAIL_SCORE_MARGIN 100
+
+// Aircraft that drop out of the feed are kept this long before removal
+#define MAX_AGE_MILLIS 15000
+
+// Positions are extrapolated from the last fix for at most this long
+#define MAX_EXTRAPOLATION_MILLIS 10000
+// The gap between the extrapolated and the newly reported position of an
+// aircraft is closed over this time instead of jumping
+#define CORRECTION_MILLIS 1000
+// Correction offsets are kept in steps of this many micro degrees
+#define CORRECTION_RESOLUTION 10
+
+// Gains of the alpha-beta track filter in 1/256. Alpha is the share of the
+// gap between predicted and reported position that moves the estimate, beta
+// the share that goes into the velocity.
+#define FILTER_ALPHA 128
+#define FILTER_BETA 43
+// Fixes closer than this to the previous one don't update the velocity
+#define FILTER_MIN_MILLIS 500
+// Fixes further than this from the predicted position are outliers: a margin
+// in micro degrees of latitude plus an error in micro degrees per second,
+// about 300 kn
+#define OUTLIER_MARGIN 2000
+#define OUTLIER_SPEED 1400
+
+// Groups of fields that sources report separately. Each has the time of its
+// fix, see FeedMerger.
+#define AIRCRAFT_POSITION 0x01
+#define AIRCRAFT_ALTITUDE 0x02
+// Speed and heading
+#define AIRCRAFT_VELOCITY 0x04
+// Call sign and squawk
+#define AIRCRAFT_IDENTITY 0x08
+// From, to, model and operator
+#define AIRCRAFT_ROUTE 0x10
+#define AIRCRAFT_ALL_FIELDS 0x1F
+#define AIRCRAFT_FIELD_GROUPS 5
+
+// An aircraft as the display uses it. The texts are StringPool ids, resolve
+// them with StringPool::get().
+struct Aircraft {
+    uint32_t icao;
+    char call[AIRCRAFT_CALL_LENGTH + 1];
+    double speed;
+    double lat;
+    double lon;
+    uint16_t altitude;
+    double distance;
+    double heading;
+    uint16_t from;
+    uint16_t to;
+    uint16_t aircraftType;
+    uint16_t operatorCode;
+    uint16_t squawk;
+    // Where the position came from, see FeedMerger::getSourceName()
+    uint8_t source;
+};
+
+// An aircraft in the compact form the store keeps it in. Clients fill one in
+// while parsing and hand it to AircraftStore::update().
+struct AircraftRecord {
+  uint32_t icao;
+  // 1e-6 degrees
+  int32_t lat;
+  int32_t lon;
+  // feet
+  uint16_t altitude;
+  // knots
+  uint16_t speed;
+  // 0.1 degrees
+  uint16_t heading;
+  // 10 m
+  uint16_t distance;
+  // StringPool ids, each holding a reference
+  uint16_t from;
+  uint16_t to;
+  uint16_t model;
+  uint16_t operatorCode;
+  // The four octal digits read as a decimal number, 7700 for "7700"
+  uint16_t squawk;
+  // Not NUL terminated if all 8 characters are used
+  char call[AIRCRAFT_CALL_LENGTH];
+};
+
+// Aircraft known to the spotter, keyed by their 24 bit ICAO address. The
+// table survives between polls: an update only touches the aircraft in the
+// current document, the others age out after MAX_AGE_MILLIS.
+//
+// The records are stored as one array per field so a few KB hold a hundred
+// aircraft. Once the table is full, a min-heap on the AircraftScore of each
+// aircraft decides in O(log n) which one makes room for a new aircraft.
+// Texts live in a StringPool shared with the display; the store holds one
+// reference per id it keeps.
+//
+// Reported positions go through a fixed-point alpha-beta filter per aircraft
+// that estimates position and velocity and rejects outliers. getAircraft()
+// and the locally built trails show the estimate, getRecord() the last
+// accepted fix.
+class AircraftStore {
+  private:
+    int count_ = 0;
+    uint32_t icaos_[MAX_AIRCRAFTS];
+    // millis() / 1000, wraps after 18 hours which is fine for aging
+    uint16_t lastSeen_[MAX_AIRCRAFTS];
+    // Last accepted fix in micro degrees
+    int32_t lats_[MAX_AIRCRAFTS];
+    int32_t lons_[MAX_AIRCRAFTS];
+    uint16_t altitudes_[MAX_AIRCRAFTS];
+    uint16_t speeds_[MAX_AIRCRAFTS];
+    uint16_t headings_[MAX_AIRCRAFTS];
+    uint16_t distances_[MAX_AIRCRAFTS];
+    uint16_t froms_[MAX_AIRCRAFTS];
+    uint16_t tos_[MAX_AIRCRAFTS];
+    uint16_t models_[MAX_AIRCRAFTS];
+    uint16_t operators_[MAX_AIRCRAFTS];
+    uint16_t squawks_[MAX_AIRCRAFTS];
+    uint16_t scores_[MAX_AIRCRAFTS];
+    // millis() of the last accepted fix
+    uint32_t fixTimes_[MAX_AIRCRAFTS];
+    // millis() at which the source had each group of fields, and the source
+    // of the position
+    uint32_t fieldTimes_[MAX_AIRCRAFTS][AIRCRAFT_FIELD_GROUPS];
+    uint8_t sources_[MAX_AIRCRAFTS];
+    // Track filter state: the estimated position at the fix as offset from
+    // it in micro degrees, and the estimated velocity in micro degrees per
+    // second
+    int16_t latOffsets_[MAX_AIRCRAFTS];
+    int16_t lonOffsets_[MAX_AIRCRAFTS];
+    int16_t latVelocities_[MAX_AIRCRAFTS];
+    int16_t lonVelocities_[MAX_AIRCRAFTS];
+    // Shown minus estimated position at the fix, in CORRECTION_RESOLUTION
+    // units. Fades out over CORRECTION_MILLIS.
+    int16_t latCorrections_[MAX_AIRCRAFTS];
+    int16_t lonCorrections_[MAX_AIRCRAFTS];
+    char calls_[MAX_AIRCRAFTS][AIRCRAFT_CALL_LENGTH];
+    uint8_t trails_[MAX_AIRCRAFTS];
+    // Min-heap of aircraft indexes by score and the heap position of each
+    // aircraft
+    uint8_t heap_[MAX_AIRCRAFTS];
+    uint8_t heapPositions_[MAX_AIRCRAFTS];
+
+    AircraftHistory histories_[MAX_TRAILS];
+    boolean trailUsed_[MAX_TRAILS];
+    // Aircraft index holding each used slot
+    uint8_t trailOwners_[MAX_TRAILS];
+    // Set once a full trail came from the server for the slot
+    boolean trailLoaded_[MAX_TRAILS];
+
+    StringPool* strings_;
+    AircraftScore* score_;
+    DistanceScore distanceScore_;
+
+    void remove(int i);
+    void heapSwap(int a, int b);
+    void heapUp(int position);
+    void heapDown(int position);
+    void heapRemove(int position);
+    void releaseStrings(int i);
+    void assignTrail(int i);
+    void extrapolate(int i, unsigned long now, int32_t& lat, int32_t& lon);
+    void resetTrack(int i, const AircraftRecord& record, unsigned long now);
+    boolean trackFix(int i, const AircraftRecord& record, unsigned long now);
+    void startCorrection(int i, int32_t shownLat, int32_t shownLon);
+
+  public:
+    AircraftStore(StringPool* strings);
+
+    // Sets what decides which aircraft are kept once the table is full, by
+    // default the closest ones are
+    void setScore(AircraftScore* score);
+
+    // Adds or updates an aircraft and marks it as seen now. history replaces the
+    // trail of the aircraft; if it is null, the position of the record is
+    // appended to the trail instead. A position the track filter rejects
+    // leaves position and distance as they were. If the table is full, the
+    // lowest scored aircraft is removed for a new one that scores higher.
+    // The store takes over the string references of the record unless it is
+    // not taken. Returns its index or -1 if it is not taken. Indexes of
+    // other aircraft can change.
+    //
+    // The groups in fields are stamped with fixMillis, the position also
+    // with the source. Use FeedMerger to keep fresher fields.
+    int update(const AircraftRecord& record, const AircraftHistory* history, unsigned long now,
+               uint8_t fields, uint8_t source, unsigned long fixMillis);
+
+    // Removes aircraft that have not been seen for MAX_AGE_MILLIS.
+    // Indexes of the remaining aircraft can change.
+    void removeStale(unsigned long now);
+
+    int find(uint32_t icao);
+
+    boolean isFull();
+
+    int getNumberOfAircrafts();
+
+    AircraftRecord getRecord(int i);
+
+    // When the source had the group of fields, one of the AIRCRAFT_POSITION
+    // etc. bits. Fields never reported are a day old.
+    unsigned long getFieldTime(int i, uint8_t field);
+
+    uint8_t getSource(int i);
+
+    Aircraft getAircraft(int i);
+
+    // Like getAircraft(), but with the position moved along the estimated
+    // velocity from the last fix to now (dead reckoning). After a new fix the
+    // position glides onto the new estimate over CORRECTION_MILLIS.
+    Aircraft getAircraft(int i, unsigned long now);
+
+    // The trail of the aircraft or null if it has no trail slot. Valid until
+    // the next update.
+    const AircraftHistory* getAircraftHistory(int i);
+
+    // Index of the aircraft with the smallest feed distance, -1 if there is
+    // none
+    int findClosest();
+
+    uint32_t getIcao(int i);
+
+    // True if the aircraft has a trail slot that was only built from its
+    // positions so far, not loaded from the server
+    boolean needsTrail(int i);
+
+    // Stops needsTrail() from asking for the trail of the aircraft again
+    void setTrailLoaded(int i);
+
+    StringPool* getStringPool();
+
+    // Prints what the store and its string pool take, and the static RAM of
+    // the whole program with otherBytes for everything else
+    void printMemoryReport(int otherBytes);
+};
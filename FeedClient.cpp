@@ -0,0 +1,132 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "FeedClient.h"
+
+FeedClient::FeedClient(FeedMerger* merger, String host, uint16_t port, const char* name) {
+  merger_ = merger;
+  store_ = merger->getStore();
+  host_ = host;
+  port_ = port;
+  name_ = name;
+  source_ = merger->addSource(name);
+}
+
+void FeedClient::setCenter(Coordinates center) {
+  center_ = center;
+}
+
+FeedStats FeedClient::getStats() {
+  return stats_;
+}
+
+void FeedClient::poll() {
+  unsigned long now = millis();
+  if (!client_.connected()) {
+    if (connectTried_ && now - connectMillis_ < FEED_RECONNECT_MILLIS) {
+      return;
+    }
+    connectTried_ = true;
+    connectMillis_ = now;
+    client_.stop();
+    // Name lookup and TCP handshake block, as in AdsbExchangeClient
+    if (!client_.connect(host_.c_str(), port_)) {
+      Serial.println(String(name_) + " connection to " + host_ + " failed");
+      return;
+    }
+    Serial.println("Connected to " + String(name_) + " feed on " + host_);
+    client_.setNoDelay(false);
+    stats_.connects++;
+    now = millis();
+    dataMillis_ = now;
+    resetFraming();
+  }
+
+  char buffer[FEED_READ_BUFFER_LENGTH];
+  for (int reads = 0; reads < FEED_READS_PER_POLL; reads++) {
+    int size = client_.available();
+    if (size <= 0) {
+      break;
+    }
+    size = client_.read((uint8_t*) buffer, size < FEED_READ_BUFFER_LENGTH ? size : FEED_READ_BUFFER_LENGTH);
+    if (size <= 0) {
+      break;
+    }
+    dataMillis_ = now;
+    parse(buffer, size, now);
+  }
+  if (now - dataMillis_ > FEED_IDLE_TIMEOUT_MILLIS) {
+    Serial.println(String(name_) + " feed silent, reconnecting");
+    client_.stop();
+  }
+
+  // Ages out the aircraft not seen for MAX_AGE_MILLIS
+  if (now - sweepMillis_ >= FEED_SWEEP_MILLIS) {
+    sweepMillis_ = now;
+    merger_->removeStale(now);
+  }
+}
+
+boolean FeedClient::loadRecord(uint32_t icao, AircraftRecord& record) {
+  int i = store_->find(icao);
+  if (i < 0) {
+    record = {};
+    record.icao = icao;
+    return false;
+  }
+  // The store gives back its references with the update
+  record = store_->getRecord(i);
+  StringPool* strings = store_->getStringPool();
+  strings->retain(record.from);
+  strings->retain(record.to);
+  strings->retain(record.model);
+  strings->retain(record.operatorCode);
+  return true;
+}
+
+// The receiver gives no time of reception we could relate to millis(), the
+// fix is when the message arrived
+void FeedClient::commitRecord(AircraftRecord& record, uint8_t fields, unsigned long now) {
+  if (fields & AIRCRAFT_POSITION) {
+    record.distance = distanceTo(record.lat, record.lon);
+  }
+  if (merger_->update(record, nullptr, fields, source_, now, now) < 0) {
+    stats_.skipped++;
+    return;
+  }
+  stats_.messages++;
+  if (fields & AIRCRAFT_POSITION) {
+    stats_.positions++;
+  }
+}
+
+// Flat earth is close enough within receiver range
+uint16_t FeedClient::distanceTo(int32_t lat, int32_t lon) {
+  float latKm = (lat / 1e6f - center_.lat) * 111.2f;
+  float lonKm = (lon / 1e6f - center_.lon) * 111.2f * cos(center_.lat * (float) PI / 180);
+  float distance = sqrt(latKm * latKm + lonKm * lonKm) * 100 + 0.5f;
+  return distance > UINT16_MAX ? UINT16_MAX : distance;
+}
@@ -0,0 +1,119 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+
+#pragma once
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClient.h>
+#include "GeoMap.h"
+
+#include "FeedMerger.h"
+
+#define FEED_READ_BUFFER_LENGTH 512
+// Reads a poll does at most, which bounds the time one poll takes
+#define FEED_READS_PER_POLL 8
+#define FEED_RECONNECT_MILLIS 5000
+// A receiver sends nothing while there is no traffic, so this is long
+#define FEED_IDLE_TIMEOUT_MILLIS 60000
+// Aircraft that stopped sending are aged out of the store this often
+#define FEED_SWEEP_MILLIS 1000
+
+// What a client got out of its feed since it was created
+struct FeedStats {
+  uint32_t connects;
+  uint32_t bytes;
+  // Lines or binary frames
+  uint32_t frames;
+  // Messages that went into the merger
+  uint32_t messages;
+  uint32_t positions;
+  // Messages about aircraft the store does not know yet that carry no
+  // position, or that the store had no room for
+  uint32_t skipped;
+  // Frames that are malformed, fail the CRC or carry nothing the store keeps
+  uint32_t ignored;
+};
+
+// Base of the clients that keep a connection to a receiver on the local
+// network open and put every message into the store as it arrives, so
+// positions are as fresh as the receiver's. Subclasses split the stream into
+// messages and decode them.
+//
+// Each message only carries some fields of an aircraft. loadRecord() and
+// commitRecord() merge them into the record the store keeps, through the
+// FeedMerger under the name of the client.
+class FeedClient {
+  private:
+    WiFiClient client_;
+    String host_;
+    uint16_t port_;
+    const char* name_;
+    uint8_t source_;
+    boolean connectTried_ = false;
+    unsigned long connectMillis_ = 0;
+    unsigned long dataMillis_ = 0;
+    unsigned long sweepMillis_ = 0;
+
+  protected:
+    FeedMerger* merger_;
+    AircraftStore* store_;
+    Coordinates center_ = {0, 0};
+    FeedStats stats_ = {};
+
+    // Called on every new connection, the stream starts over
+    virtual void resetFraming() = 0;
+
+    // The record of icao with the references of its strings, for a message
+    // to be merged into. Returns false if the store does not know the
+    // aircraft; record is then empty.
+    boolean loadRecord(uint32_t icao, AircraftRecord& record);
+
+    // Hands the record from loadRecord() to the merger. fields are the
+    // groups the message set, AIRCRAFT_POSITION etc.
+    void commitRecord(AircraftRecord& record, uint8_t fields, unsigned long now);
+
+    // In 10 m from the center
+    uint16_t distanceTo(int32_t lat, int32_t lon);
+
+  public:
+    FeedClient(FeedMerger* merger, String host, uint16_t port, const char* name);
+
+    virtual ~FeedClient() {}
+
+    // The distance of each aircraft is measured from here
+    void setCenter(Coordinates center);
+
+    // Connects or reconnects if needed and parses what has arrived, without
+    // waiting for more. Call it from loop().
+    void poll();
+
+    // Parses feed data received at now, in pieces of any size
+    virtual void parse(const char* data, size_t length, unsigned long now) = 0;
+
+    FeedStats getStats();
+};
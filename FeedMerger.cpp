@@ -0,0 +1,194 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "FeedMerger.h"
+
+FeedMerger::FeedMerger(AircraftStore* store) {
+  store_ = store;
+}
+
+uint8_t FeedMerger::addSource(const char* name) {
+  if (sourceCount_ == MAX_FEED_SOURCES) {
+    return MAX_FEED_SOURCES - 1;
+  }
+  names_[sourceCount_] = name;
+  return sourceCount_++;
+}
+
+const char* FeedMerger::getSourceName(uint8_t source) {
+  return source < sourceCount_ ? names_[source] : "";
+}
+
+uint8_t FeedMerger::getNumberOfSources() {
+  return sourceCount_;
+}
+
+int FeedMerger::update(AircraftRecord& record, const AircraftHistory* history, uint8_t fields, uint8_t source,
+                       unsigned long fixMillis, unsigned long now) {
+  if (source >= MAX_FEED_SOURCES) {
+    source = MAX_FEED_SOURCES - 1;
+  }
+  // Clocks of servers run ahead of ours at times
+  if ((int32_t) (fixMillis - now) > 0) {
+    fixMillis = now;
+  }
+  SourceStats& stats = stats_[source];
+  stats.updates++;
+  int i = store_->find(record.icao);
+  if (i >= 0) {
+    AircraftRecord known = store_->getRecord(i);
+    for (uint8_t field = 1; field <= AIRCRAFT_ROUTE; field <<= 1) {
+      if (!(fields & field)) {
+        keepKnown(record, known, field);
+      } else if ((int32_t) (fixMillis - store_->getFieldTime(i, field)) < 0) {
+        keepKnown(record, known, field);
+        fields &= ~field;
+        stats.staleFields++;
+      }
+    }
+  }
+
+  i = store_->update(record, history, now, fields, source, fixMillis);
+  if (i < 0) {
+    StringPool* strings = store_->getStringPool();
+    strings->release(record.from);
+    strings->release(record.to);
+    strings->release(record.model);
+    strings->release(record.operatorCode);
+    return -1;
+  }
+  // Unless the track filter took it for an outlier
+  if ((fields & AIRCRAFT_POSITION) && store_->getFieldTime(i, AIRCRAFT_POSITION) == (uint32_t) fixMillis
+      && store_->getSource(i) == source) {
+    int32_t age = lastFrameMillis_ - fixMillis;
+    pending_[source]++;
+    pendingAges_[source] += age;
+    if (pending_[source] == 1 || age > pendingMaxAge_[source]) {
+      pendingMaxAge_[source] = age;
+    }
+  }
+  return i;
+}
+
+// Puts the values the store has for a group of fields into the record
+void FeedMerger::keepKnown(AircraftRecord& record, const AircraftRecord& known, uint8_t field) {
+  switch (field) {
+    case AIRCRAFT_POSITION:
+      record.lat = known.lat;
+      record.lon = known.lon;
+      record.distance = known.distance;
+      break;
+    case AIRCRAFT_ALTITUDE:
+      record.altitude = known.altitude;
+      break;
+    case AIRCRAFT_VELOCITY:
+      record.speed = known.speed;
+      record.heading = known.heading;
+      break;
+    case AIRCRAFT_IDENTITY:
+      memcpy(record.call, known.call, AIRCRAFT_CALL_LENGTH);
+      record.squawk = known.squawk;
+      break;
+    case AIRCRAFT_ROUTE: {
+      // Receivers start from the known record, most of the time there is
+      // nothing to swap
+      if (record.from == known.from && record.to == known.to && record.model == known.model
+          && record.operatorCode == known.operatorCode) {
+        break;
+      }
+      // The record holds a reference to each of its strings
+      StringPool* strings = store_->getStringPool();
+      strings->release(record.from);
+      strings->release(record.to);
+      strings->release(record.model);
+      strings->release(record.operatorCode);
+      record.from = known.from;
+      record.to = known.to;
+      record.model = known.model;
+      record.operatorCode = known.operatorCode;
+      strings->retain(record.from);
+      strings->retain(record.to);
+      strings->retain(record.model);
+      strings->retain(record.operatorCode);
+      break;
+    }
+  }
+}
+
+void FeedMerger::removeStale(unsigned long now) {
+  store_->removeStale(now);
+}
+
+void FeedMerger::frameDrawn(unsigned long now) {
+  // Signed, so a frame stamped before the previous one, as spotter_host
+  // --frames does when it draws ahead of millis(), counts as a negative gap
+  // instead of 49 days. Also right across the millis() wrap.
+  int32_t sinceLastFrame = now - lastFrameMillis_;
+  for (int source = 0; source < MAX_FEED_SOURCES; source++) {
+    uint16_t count = pending_[source];
+    if (count == 0) {
+      continue;
+    }
+    SourceStats& stats = stats_[source];
+    stats.displayed += count;
+    stats.latencySum += pendingAges_[source] + (int64_t) count * sinceLastFrame;
+    int32_t maxLatency = pendingMaxAge_[source] + sinceLastFrame;
+    if (maxLatency > 0 && (uint32_t) maxLatency > stats.maxLatency) {
+      stats.maxLatency = maxLatency;
+    }
+    pending_[source] = 0;
+    pendingAges_[source] = 0;
+  }
+  lastFrameMillis_ = now;
+}
+
+SourceStats FeedMerger::getSourceStats(uint8_t source) {
+  return source < MAX_FEED_SOURCES ? stats_[source] : SourceStats{};
+}
+
+AircraftStore* FeedMerger::getStore() {
+  return store_;
+}
+
+int FeedMerger::getNumberOfAircrafts() {
+  return store_->getNumberOfAircrafts();
+}
+
+Aircraft FeedMerger::getAircraft(int i) {
+  return store_->getAircraft(i);
+}
+
+Aircraft FeedMerger::getAircraft(int i, unsigned long now) {
+  return store_->getAircraft(i, now);
+}
+
+const AircraftHistory* FeedMerger::getAircraftHistory(int i) {
+  return store_->getAircraftHistory(i);
+}
+
+int FeedMerger::findClosestAircraft() {
+  return store_->findClosest();
+}
@@ -0,0 +1,115 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "AircraftStore.h"
+
+// Sources the merger tells apart, a receiver and ADS-B Exchange need two
+#define MAX_FEED_SOURCES 4
+
+// Positions of one source that reached the display and how long after their
+// fix they got there
+struct SourceStats {
+  // Records merged, and groups of fields in them that were older than the
+  // ones of another source and dropped
+  uint32_t updates;
+  uint32_t staleFields;
+  uint32_t displayed;
+  uint64_t latencySum;
+  uint32_t maxLatency;
+};
+
+// Merges the aircraft of several feeds, say a local receiver and ADS-B
+// Exchange, into one AircraftStore, which the display reads through it.
+// Records are matched by their ICAO address. Each group of fields
+// (AIRCRAFT_POSITION etc.) keeps the value of the source with the latest fix
+// time, so a delayed ADS-B Exchange answer doesn't move an aircraft back
+// behind the receiver's position, while its route still fills in what the
+// receiver doesn't know. getAircraft() tells where the position came from.
+//
+// frameDrawn() measures how long positions take from their fix to the
+// display, per source. A receiver's fix is the arrival of its message, an
+// ADS-B Exchange fix the PosTime the server reports.
+class FeedMerger {
+  private:
+    AircraftStore* store_;
+    const char* names_[MAX_FEED_SOURCES];
+    uint8_t sourceCount_ = 0;
+    SourceStats stats_[MAX_FEED_SOURCES] = {};
+    // Positions merged since the last frame: how many, the sum of their ages
+    // at the last frame, which is negative for fixes after it, and the
+    // largest of them
+    uint16_t pending_[MAX_FEED_SOURCES] = {};
+    int64_t pendingAges_[MAX_FEED_SOURCES] = {};
+    int32_t pendingMaxAge_[MAX_FEED_SOURCES] = {};
+    unsigned long lastFrameMillis_ = 0;
+
+    void keepKnown(AircraftRecord& record, const AircraftRecord& known, uint8_t field);
+
+  public:
+    FeedMerger(AircraftStore* store);
+
+    // Registers a feed and returns the source id to pass to update(). Once
+    // MAX_FEED_SOURCES are taken, further feeds share the last id.
+    uint8_t addSource(const char* name);
+
+    const char* getSourceName(uint8_t source);
+
+    uint8_t getNumberOfSources();
+
+    // Merges a record a source had at fixMillis into the store, like
+    // AircraftStore::update(). fields are the groups the record carries; the
+    // others and those older than what the store holds keep their values.
+    // Takes over the string references of the record either way. Returns the
+    // index of the aircraft or -1 if the store has no room for it.
+    int update(AircraftRecord& record, const AircraftHistory* history, uint8_t fields, uint8_t source,
+               unsigned long fixMillis, unsigned long now);
+
+    // See AircraftStore::removeStale(). Feeds call it after their updates.
+    void removeStale(unsigned long now);
+
+    // Call after each frame that showed the aircraft
+    void frameDrawn(unsigned long now);
+
+    SourceStats getSourceStats(uint8_t source);
+
+    AircraftStore* getStore();
+
+    int getNumberOfAircrafts();
+
+    Aircraft getAircraft(int i);
+
+    // The aircraft at its extrapolated position, see AircraftStore
+    Aircraft getAircraft(int i, unsigned long now);
+
+    // Null if the aircraft has no trail
+    const AircraftHistory* getAircraftHistory(int i);
+
+    // Index of the aircraft closest to the center, -1 if there are none
+    int findClosestAircraft();
+};
@@ -73,7 +73,6 @@ CoordinatesPixel GeoMap::convertToPixel(Coordinates coordinates) {
 
 CoordinatesTiles GeoMap::convertToTiles(Coordinates coordinates) {
   
-  double lon_rad = coordinates.lon * PI / 180;
   double lat_rad = coordinates.lat * PI / 180;;
   double n = pow(2.0, zoom_);
 
@@ -96,6 +95,12 @@ Coordinates GeoMap::convertToCoordinatesFromTiles(CoordinatesTiles tiles) {
   return result;
 }
 
+// The equator is 256 * 2^zoom pixels long, shrinking with the cosine of
+// the latitude
+float GeoMap::getMetersPerPixel() {
+  return 40075016.7 * cos(mapCenter_.lat * PI / 180) / (MAPQUEST_TILE_LENGTH * pow(2.0, zoom_));
+}
+
 Coordinates GeoMap::convertToCoordinates(CoordinatesPixel poiPixel) {
   CoordinatesTiles centerTile = convertToTiles(mapCenter_);
   CoordinatesTiles poiTile;
@@ -113,79 +118,124 @@ void GeoMap::downloadFile(String url, String filename) {
 }
 
 void GeoMap::downloadFile(String url, String filename, ProgressCallback progressCallback) {
-    Serial.println("Downloading " + url + " and saving as " + filename);
+  Serial.println("Downloading " + url + " and saving as " + filename);
+
+  if (SPIFFS.exists(filename) == true) {
+    Serial.println("File already exists. Skipping");
+    //return;
+  }
 
-    if (SPIFFS.exists(filename) == true) {
-      Serial.println("File already exists. Skipping");
-      //return;
+  // http://host[:port]/path, the map providers are asked over plain HTTP
+  int start = url.indexOf("://");
+  String host = start >= 0 ? url.substring(start + 3) : url;
+  int slash = host.indexOf('/');
+  String path = slash >= 0 ? host.substring(slash) : String("/");
+  if (slash >= 0) {
+    host = host.substring(0, slash);
+  }
+  uint16_t port = 80;
+  int colon = host.indexOf(':');
+  if (colon >= 0) {
+    port = host.substring(colon + 1).toInt();
+    host = host.substring(0, colon);
+  }
+
+  Metrics.count(Counter::MapDownloads);
+  WiFiClient client;
+  unsigned long connectStart = millis();
+  boolean connected = client.connect(host.c_str(), port);
+  Metrics.record(Metric::MapConnect, millis() - connectStart);
+  if (!connected) {
+    Serial.println("[HTTP] connection failed");
+    Metrics.count(Counter::MapFailures);
+    return;
+  }
+  client.print(String("GET ") + path + " HTTP/1.1\r\n" +
+               "Host: " + host + "\r\n" +
+               "Connection: close\r\n\r\n");
+
+  // The body goes to DOWNLOAD_TEMP_FILE and replaces the file only once it
+  // is complete, so a failed download leaves the previous map in place
+  HttpResponseParser response;
+  fs::File f;
+  char buffer[HTTP_READ_BUFFER_LENGTH];
+  uint32_t downloaded = 0;
+  uint32_t received = 0;
+  unsigned long sentMillis = millis();
+  unsigned long firstByteMillis = 0;
+  unsigned long dataMillis = sentMillis;
+  boolean closed = false;
+  while (!response.isDone()) {
+    int size = client.available();
+    if (size <= 0) {
+      // Without Content-Length the file ends with the connection
+      if (!client.connected()) {
+        closed = true;
+        break;
+      }
+      unsigned long timeout = response.isInBody() ? HTTP_IDLE_TIMEOUT_MILLIS : HTTP_RESPONSE_TIMEOUT_MILLIS;
+      if (millis() - dataMillis > timeout) {
+        Serial.println("[HTTP] timeout");
+        break;
+      }
+      delay(1);
+      continue;
+    }
+    size = client.read((uint8_t*) buffer, size < HTTP_READ_BUFFER_LENGTH ? size : HTTP_READ_BUFFER_LENGTH);
+    if (size <= 0) {
+      continue;
     }
-    // wait for WiFi connection
-    ESP8266WiFiMulti _wifiMulti;
-    if((_wifiMulti.run() == WL_CONNECTED)) {
-        HTTPClient http;
-
-        Serial.print("[HTTP] begin...\n");
-
-        // configure server and url
-        http.begin(url);
-
-        Serial.print("[HTTP] GET...\n");
-        // start connection and send HTTP header
-        int httpCode = http.GET();
-        if(httpCode > 0) {
-            //SPIFFS.remove(filename);
-            fs::File f = SPIFFS.open(filename, "w+");
-            if (!f) {
-                Serial.println("file open failed");
-                return;
-            }
-            // HTTP header has been send and Server response header has been handled
-            Serial.printf("[HTTP] GET... code: %d\n", httpCode);
-
-            // file found at server
-            if(httpCode == HTTP_CODE_OK) {
-
-                // get lenght of document (is -1 when Server sends no Content-Length header)
-                int total = http.getSize();
-                int len = total;
-                progressCallback(filename, 0,total);
-                // create buffer for read
-                uint8_t buff[128] = { 0 };
-
-                // get tcp stream
-                WiFiClient * stream = http.getStreamPtr();
-
-                // read all data from server
-                while(http.connected() && (len > 0 || len == -1)) {
-                    // get available data size
-                    size_t size = stream->available();
-
-                    if(size) {
-                        // read up to 128 byte
-                        int c = stream->readBytes(buff, ((size > sizeof(buff)) ? sizeof(buff) : size));
-
-                        // write it to Serial
-                        f.write(buff, c);
-
-                        if(len > 0) {
-                            len -= c;
-                        }
-                        progressCallback(filename, total - len,total);
-                    }
-                    delay(1);
-                }
-
-                Serial.println();
-                Serial.print("[HTTP] connection closed or file end.\n");
-
-            }
-            f.close();
-        } else {
-            Serial.printf("[HTTP] GET... failed, error: %s\n", http.errorToString(httpCode).c_str());
-        }
-        
-        http.end();
+    dataMillis = millis();
+    if (received == 0) {
+      firstByteMillis = dataMillis;
+      Metrics.record(Metric::MapFirstByte, firstByteMillis - sentMillis);
     }
+    received += size;
+    size_t bodyLength = response.parse(buffer, size);
+    if (!response.isInBody()) {
+      continue;
+    }
+    if (!f) {
+      Serial.printf("[HTTP] GET... code: %d\n", response.getStatusCode());
+      if (!response.isSuccess()) {
+        break;
+      }
+      f = SPIFFS.open(DOWNLOAD_TEMP_FILE, "w+");
+      if (!f) {
+        Serial.println("file open failed");
+        break;
+      }
+      if (progressCallback) {
+        progressCallback(filename, 0, response.getContentLength());
+      }
+    }
+    if (f.write((uint8_t*) buffer, bodyLength) != bodyLength) {
+      Serial.println("file write failed");
+      break;
+    }
+    downloaded += bodyLength;
+    if (progressCallback) {
+      progressCallback(filename, downloaded, response.getContentLength());
+    }
+  }
+  client.stop();
+  int32_t length = response.getContentLength();
+  boolean saved = f && (response.isDone() || (closed && length < 0)) && (length < 0 || downloaded == (uint32_t) length);
+  if (f) {
+    f.close();
+    if (saved) {
+      SPIFFS.remove(filename);
+      saved = SPIFFS.rename(DOWNLOAD_TEMP_FILE, filename);
+    } else {
+      SPIFFS.remove(DOWNLOAD_TEMP_FILE);
+    }
+  }
+  if (saved) {
+    Metrics.record(Metric::MapTransfer, dataMillis - firstByteMillis);
+    Metrics.record(Metric::MapBytes, received);
+  } else {
+    Metrics.count(Counter::MapFailures);
+  }
 }
 
 
@@ -27,10 +27,12 @@ See more at https://blog.squix.org
 #define FS_NO_GLOBALS
 #include <FS.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WiFiMulti.h>
-#include <ESP8266HTTPClient.h>
+#include "HttpResponseParser.h"
+#include "Metrics.h"
 
 #define MAPQUEST_TILE_LENGTH 256.0
+// Downloads are written here and renamed once complete
+#define DOWNLOAD_TEMP_FILE "/download.tmp"
 
 typedef void (*ProgressCallback)(String fileName, uint32_t bytesDownloaded, uint32_t bytesTotal);
 
@@ -73,6 +75,8 @@ class GeoMap {
     Coordinates convertToCoordinatesFromTiles(CoordinatesTiles tiles);
     void downloadFile(String url, String filename, ProgressCallback progressCallback);
     void downloadFile(String url, String filename);
+    // Ground distance one pixel covers at the map center
+    float getMetersPerPixel();
     int getMapWidth();
     int getMapHeight();
   
@@ -0,0 +1,194 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "HttpResponseParser.h"
+
+HttpResponseParser::HttpResponseParser() {
+  reset();
+}
+
+void HttpResponseParser::reset() {
+  state_ = HttpState::StatusLine;
+  lineLength_ = 0;
+  chunked_ = false;
+  keepAlive_ = false;
+  hasLength_ = false;
+  statusCode_ = 0;
+  contentLength_ = -1;
+  encoding_ = HttpEncoding::Identity;
+  remaining_ = 0;
+}
+
+bool HttpResponseParser::isInBody() {
+  return state_ != HttpState::StatusLine && state_ != HttpState::HeaderLine;
+}
+
+int HttpResponseParser::getStatusCode() {
+  return statusCode_;
+}
+
+bool HttpResponseParser::isSuccess() {
+  return statusCode_ >= 200 && statusCode_ < 300;
+}
+
+int32_t HttpResponseParser::getContentLength() {
+  return contentLength_;
+}
+
+bool HttpResponseParser::isDone() {
+  return state_ == HttpState::Done;
+}
+
+HttpEncoding HttpResponseParser::getContentEncoding() {
+  return encoding_;
+}
+
+bool HttpResponseParser::isKeepAlive() {
+  return keepAlive_;
+}
+
+size_t HttpResponseParser::parse(char* data, size_t length) {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < length) {
+    switch (state_) {
+      case HttpState::Body:
+      case HttpState::ChunkData:
+        out = moveBody(data, in, length, out);
+        break;
+      case HttpState::Done:
+        // Nothing may follow the response on a connection we reuse
+        return out;
+      default: {
+        char c = data[in++];
+        if (c == '\n') {
+          line_[lineLength_] = '\0';
+          endLine();
+          lineLength_ = 0;
+        } else if (c != '\r' && lineLength_ < HTTP_LINE_LENGTH) {
+          line_[lineLength_++] = c;
+        }
+        break;
+      }
+    }
+  }
+  return out;
+}
+
+// Moves the body bytes at in to out, up to the end of the body or chunk
+size_t HttpResponseParser::moveBody(char* data, size_t& in, size_t length, size_t out) {
+  size_t count = length - in;
+  bool bounded = state_ == HttpState::ChunkData || hasLength_;
+  if (bounded && count > remaining_) {
+    count = remaining_;
+  }
+  memmove(data + out, data + in, count);
+  in += count;
+  if (bounded) {
+    remaining_ -= count;
+    if (remaining_ == 0) {
+      state_ = state_ == HttpState::ChunkData ? HttpState::ChunkEnd : HttpState::Done;
+    }
+  }
+  return out + count;
+}
+
+void HttpResponseParser::endLine() {
+  switch (state_) {
+    case HttpState::StatusLine:
+      // "HTTP/1.1 200 OK". HTTP/1.1 keeps the connection unless the server
+      // says otherwise.
+      if (strncmp(line_, "HTTP/1.", 7) == 0 && lineLength_ >= 12 && line_[8] == ' ') {
+        statusCode_ = atoi(line_ + 9);
+      }
+      keepAlive_ = strncmp(line_, "HTTP/1.1", 8) == 0;
+      state_ = HttpState::HeaderLine;
+      break;
+    case HttpState::HeaderLine:
+      if (lineLength_ == 0) {
+        endHeader();
+      } else if (strncasecmp(line_, "Content-Length:", 15) == 0) {
+        hasLength_ = true;
+        remaining_ = strtoul(line_ + 15, nullptr, 10);
+        contentLength_ = remaining_;
+      } else if (strncasecmp(line_, "Transfer-Encoding:", 18) == 0) {
+        chunked_ = strstr(line_ + 18, "chunked") != nullptr;
+      } else if (strncasecmp(line_, "Content-Encoding:", 17) == 0) {
+        if (strstr(line_ + 17, "gzip") != nullptr) {
+          encoding_ = HttpEncoding::Gzip;
+        } else if (strstr(line_ + 17, "deflate") != nullptr) {
+          encoding_ = HttpEncoding::Deflate;
+        }
+      } else if (strncasecmp(line_, "Connection:", 11) == 0) {
+        const char* value = line_ + 11;
+        while (*value == ' ') {
+          value++;
+        }
+        if (strncasecmp(value, "close", 5) == 0) {
+          keepAlive_ = false;
+        } else if (strncasecmp(value, "keep-alive", 10) == 0) {
+          keepAlive_ = true;
+        }
+      }
+      break;
+    case HttpState::ChunkSize:
+      // Chunk extensions after ';' end the hex number as well
+      remaining_ = strtoul(line_, nullptr, 16);
+      state_ = remaining_ > 0 ? HttpState::ChunkData : HttpState::Trailer;
+      break;
+    case HttpState::ChunkEnd:
+      state_ = HttpState::ChunkSize;
+      break;
+    case HttpState::Trailer:
+      if (lineLength_ == 0) {
+        state_ = HttpState::Done;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Chunked framing wins over Content-Length, as RFC 7230 says
+void HttpResponseParser::endHeader() {
+  if (statusCode_ >= 100 && statusCode_ < 200) {
+    // The real response follows
+    reset();
+    return;
+  }
+  if (statusCode_ == 204 || statusCode_ == 304) {
+    state_ = HttpState::Done;
+  } else if (chunked_) {
+    contentLength_ = -1;
+    hasLength_ = false;
+    state_ = HttpState::ChunkSize;
+  } else if (hasLength_) {
+    state_ = remaining_ > 0 ? HttpState::Body : HttpState::Done;
+  } else {
+    // The body ends with the connection
+    keepAlive_ = false;
+    state_ = HttpState::Body;
+  }
+}
@@ -0,0 +1,118 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Size of the stack buffer the clients read socket data into
+#define HTTP_READ_BUFFER_LENGTH 512
+// Reads of HTTP_READ_BUFFER_LENGTH a non-blocking client does per poll, which
+// bounds the time one poll takes
+#define HTTP_READS_PER_POLL 8
+// Time the server gets to start answering, and the longest pause in the
+// middle of an answer
+#define HTTP_RESPONSE_TIMEOUT_MILLIS 10000
+#define HTTP_IDLE_TIMEOUT_MILLIS 5000
+// Header lines are kept up to this length, enough for the headers the parser
+// reads. The rest of a longer line is ignored.
+#define HTTP_LINE_LENGTH 48
+
+enum class HttpState : uint8_t {
+  StatusLine,
+  HeaderLine,
+  // Until Content-Length bytes are read, or until the connection closes if
+  // the response has neither length nor chunks
+  Body,
+  ChunkSize,
+  ChunkData,
+  // The line break after the data of a chunk
+  ChunkEnd,
+  Trailer,
+  Done
+};
+
+// Content-Encoding of the body. Only sent if the request asked for it with
+// Accept-Encoding.
+enum class HttpEncoding : uint8_t {
+  Identity,
+  Gzip,
+  Deflate
+};
+
+// Splits an HTTP/1.1 response read in arbitrary chunks into header and body.
+// It finds the end of the body from Content-Length or the chunked transfer
+// encoding, so the connection can be used for the next request. Interim 1xx
+// responses are skipped.
+class HttpResponseParser {
+  private:
+    HttpState state_ = HttpState::StatusLine;
+    char line_[HTTP_LINE_LENGTH + 1];
+    uint8_t lineLength_ = 0;
+    bool chunked_ = false;
+    bool keepAlive_ = false;
+    bool hasLength_ = false;
+    // 0 until the status line is read, or if it is not HTTP
+    int statusCode_ = 0;
+    int32_t contentLength_ = -1;
+    HttpEncoding encoding_ = HttpEncoding::Identity;
+    // Body or chunk bytes still to come
+    uint32_t remaining_ = 0;
+
+    void endLine();
+    void endHeader();
+    size_t moveBody(char* data, size_t& in, size_t length, size_t out);
+
+  public:
+    HttpResponseParser();
+
+    void reset();
+
+    // Consumes the header and chunk framing bytes in data, moves the body
+    // bytes to the front of data and returns how many there are.
+    size_t parse(char* data, size_t length);
+
+    // True once the header has been read, also if the response turns out to
+    // have no body
+    bool isInBody();
+
+    int getStatusCode();
+
+    // True for a 2xx status. Callers check this once isInBody() and drop the
+    // body of anything else instead of parsing an error page.
+    bool isSuccess();
+
+    // -1 if the header has no Content-Length or the body is chunked
+    int32_t getContentLength();
+
+    // True once the whole body has been read. Never true for a body that
+    // ends when the connection closes.
+    bool isDone();
+
+    HttpEncoding getContentEncoding();
+
+    // True if the server keeps the connection open after the response
+    bool isKeepAlive();
+};
@@ -0,0 +1,491 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "Inflater.h"
+
+#define GZIP_FLAG_HEADER_CRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+// Returned by peekSymbol() if more bits are needed or the code is invalid
+#define NEED_BITS -1
+#define INVALID_CODE -2
+
+static const uint16_t LENGTH_BASES[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LENGTH_EXTRA_BITS[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DISTANCE_BASES[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+  4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DISTANCE_EXTRA_BITS[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+// Order in which the code length code lengths are stored
+static const uint8_t CODE_LENGTH_ORDER[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+Inflater::Inflater() {
+  reset(InflateFormat::Gzip);
+}
+
+void Inflater::reset(InflateFormat format) {
+  state_ = format == InflateFormat::Gzip ? InflateState::GzipHeader : InflateState::ZlibHeader;
+  bitBuffer_ = 0;
+  bitCount_ = 0;
+  final_ = false;
+  windowTooSmall_ = false;
+  flags_ = 0;
+  trailerLength_ = format == InflateFormat::Gzip ? 8 : 0;
+  counter_ = 0;
+  remaining_ = 0;
+  windowPos_ = 0;
+  windowFill_ = 0;
+}
+
+bool Inflater::isDone() {
+  return state_ == InflateState::Done;
+}
+
+bool Inflater::hasError() {
+  return state_ == InflateState::Error;
+}
+
+bool Inflater::isWindowTooSmall() {
+  return windowTooSmall_;
+}
+
+void Inflater::fail() {
+  state_ = InflateState::Error;
+}
+
+size_t Inflater::inflate(const uint8_t* in, size_t inLength, size_t& consumed, uint8_t* out, size_t outLength) {
+  consumed = 0;
+  size_t produced = 0;
+  do {
+    while (bitCount_ <= 24 && consumed < inLength) {
+      bitBuffer_ |= (uint32_t) in[consumed++] << bitCount_;
+      bitCount_ += 8;
+    }
+  } while (step(out, outLength, produced));
+  return produced;
+}
+
+uint32_t Inflater::takeBits(uint8_t count) {
+  uint32_t bits = bitBuffer_ & ((1UL << count) - 1);
+  bitBuffer_ >>= count;
+  bitCount_ -= count;
+  return bits;
+}
+
+// Canonical Huffman decoding one bit at a time, without taking the bits.
+// counts[n] is the number of codes of length n, symbols are sorted by code.
+int Inflater::peekSymbol(const uint16_t* counts, const uint16_t* symbols, uint8_t& length) {
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int bits = 1; bits <= INFLATE_MAX_BITS; bits++) {
+    if (bits > bitCount_) {
+      return NEED_BITS;
+    }
+    code |= (bitBuffer_ >> (bits - 1)) & 1;
+    int count = counts[bits];
+    if (code - first < count) {
+      length = bits;
+      return symbols[index + code - first];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return INVALID_CODE;
+}
+
+// Incomplete codes are accepted, a missing code fails when it is decoded
+bool Inflater::buildTree(uint16_t* counts, uint16_t* symbols, const uint8_t* lengths, int count) {
+  uint16_t offsets[INFLATE_MAX_BITS + 1];
+  memset(counts, 0, (INFLATE_MAX_BITS + 1) * sizeof(uint16_t));
+  for (int i = 0; i < count; i++) {
+    counts[lengths[i]]++;
+  }
+  int left = 1;
+  for (int bits = 1; bits <= INFLATE_MAX_BITS; bits++) {
+    left = (left << 1) - counts[bits];
+    if (left < 0) {
+      return false;
+    }
+  }
+  offsets[1] = 0;
+  for (int bits = 1; bits < INFLATE_MAX_BITS; bits++) {
+    offsets[bits + 1] = offsets[bits] + counts[bits];
+  }
+  for (int i = 0; i < count; i++) {
+    if (lengths[i] != 0) {
+      symbols[offsets[lengths[i]]++] = i;
+    }
+  }
+  return true;
+}
+
+void Inflater::buildFixedTrees() {
+  for (int i = 0; i < INFLATE_LITERAL_CODES; i++) {
+    lengths_[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+  }
+  buildTree(literalCounts_, literalSymbols_, lengths_, INFLATE_LITERAL_CODES);
+  memset(lengths_, 5, 30);
+  buildTree(distanceCounts_, distanceSymbols_, lengths_, 30);
+}
+
+// Moves to the next optional gzip header field, or to the data
+void Inflater::nextGzipField() {
+  counter_ = 0;
+  if (flags_ & GZIP_FLAG_EXTRA) {
+    flags_ &= ~GZIP_FLAG_EXTRA;
+    state_ = InflateState::GzipExtraLength;
+  } else if (flags_ & GZIP_FLAG_NAME) {
+    flags_ &= ~GZIP_FLAG_NAME;
+    state_ = InflateState::GzipName;
+  } else if (flags_ & GZIP_FLAG_COMMENT) {
+    flags_ &= ~GZIP_FLAG_COMMENT;
+    state_ = InflateState::GzipComment;
+  } else if (flags_ & GZIP_FLAG_HEADER_CRC) {
+    flags_ &= ~GZIP_FLAG_HEADER_CRC;
+    state_ = InflateState::GzipHeaderCrc;
+  } else {
+    state_ = InflateState::BlockHeader;
+  }
+}
+
+void Inflater::endBlock() {
+  if (!final_) {
+    state_ = InflateState::BlockHeader;
+    return;
+  }
+  // The trailer starts at the next byte
+  takeBits(bitCount_ % 8);
+  counter_ = 0;
+  state_ = trailerLength_ > 0 ? InflateState::Trailer : InflateState::Done;
+}
+
+// Does one step of decoding. Returns false if it needs more input or more
+// room in out, or if the stream has ended.
+bool Inflater::step(uint8_t* out, size_t outLength, size_t& produced) {
+  switch (state_) {
+    case InflateState::GzipHeader: {
+      if (bitCount_ < 8) {
+        return false;
+      }
+      uint8_t value = takeBits(8);
+      if ((counter_ == 0 && value != 0x1f) || (counter_ == 1 && value != 0x8b) || (counter_ == 2 && value != 8)) {
+        fail();
+        return false;
+      }
+      if (counter_ == 3) {
+        flags_ = value;
+      }
+      // Flags are followed by time, extra flags and operating system
+      if (++counter_ == 10) {
+        nextGzipField();
+      }
+      return true;
+    }
+    case InflateState::GzipExtraLength:
+      if (bitCount_ < 16) {
+        return false;
+      }
+      remaining_ = takeBits(16);
+      state_ = InflateState::GzipExtra;
+      return true;
+    case InflateState::GzipExtra:
+      if (remaining_ == 0) {
+        nextGzipField();
+        return true;
+      }
+      if (bitCount_ < 8) {
+        return false;
+      }
+      takeBits(8);
+      remaining_--;
+      return true;
+    case InflateState::GzipName:
+    case InflateState::GzipComment:
+      if (bitCount_ < 8) {
+        return false;
+      }
+      if (takeBits(8) == 0) {
+        nextGzipField();
+      }
+      return true;
+    case InflateState::GzipHeaderCrc:
+      if (bitCount_ < 16) {
+        return false;
+      }
+      takeBits(16);
+      nextGzipField();
+      return true;
+    case InflateState::ZlibHeader: {
+      if (bitCount_ < 16) {
+        return false;
+      }
+      uint8_t method = bitBuffer_ & 0xff;
+      uint8_t flags = (bitBuffer_ >> 8) & 0xff;
+      if ((method & 0x0f) == 8 && ((method << 8) | flags) % 31 == 0) {
+        if (flags & 0x20) {
+          // Preset dictionaries are not used over HTTP
+          fail();
+          return false;
+        }
+        takeBits(16);
+        // Adler-32 of the data
+        trailerLength_ = 4;
+      }
+      state_ = InflateState::BlockHeader;
+      return true;
+    }
+    case InflateState::BlockHeader: {
+      if (bitCount_ < 3) {
+        return false;
+      }
+      final_ = takeBits(1);
+      uint8_t type = takeBits(2);
+      if (type == 0) {
+        takeBits(bitCount_ % 8);
+        state_ = InflateState::StoredLength;
+      } else if (type == 1) {
+        buildFixedTrees();
+        state_ = InflateState::Codes;
+      } else if (type == 2) {
+        state_ = InflateState::DynamicCounts;
+      } else {
+        fail();
+        return false;
+      }
+      return true;
+    }
+    case InflateState::StoredLength: {
+      if (bitCount_ < 32) {
+        return false;
+      }
+      uint16_t length = takeBits(16);
+      uint16_t complement = takeBits(16);
+      if (length != (uint16_t) ~complement) {
+        fail();
+        return false;
+      }
+      remaining_ = length;
+      if (remaining_ == 0) {
+        endBlock();
+      } else {
+        state_ = InflateState::Stored;
+      }
+      return true;
+    }
+    case InflateState::DynamicCounts:
+      if (bitCount_ < 14) {
+        return false;
+      }
+      literalCount_ = takeBits(5) + 257;
+      distanceCount_ = takeBits(5) + 1;
+      codeLengthCount_ = takeBits(4) + 4;
+      if (literalCount_ > 286 || distanceCount_ > 30) {
+        fail();
+        return false;
+      }
+      counter_ = 0;
+      state_ = InflateState::CodeLengthCodes;
+      return true;
+    case InflateState::CodeLengthCodes:
+      if (bitCount_ < 3) {
+        return false;
+      }
+      lengths_[CODE_LENGTH_ORDER[counter_++]] = takeBits(3);
+      if (counter_ == codeLengthCount_) {
+        for (; counter_ < 19; counter_++) {
+          lengths_[CODE_LENGTH_ORDER[counter_]] = 0;
+        }
+        if (!buildTree(distanceCounts_, distanceSymbols_, lengths_, 19)) {
+          fail();
+          return false;
+        }
+        counter_ = 0;
+        state_ = InflateState::CodeLengths;
+      }
+      return true;
+    case InflateState::CodeLengths: {
+      uint8_t length;
+      int symbol = peekSymbol(distanceCounts_, distanceSymbols_, length);
+      if (symbol == NEED_BITS) {
+        return false;
+      }
+      if (symbol == INVALID_CODE) {
+        fail();
+        return false;
+      }
+      int total = literalCount_ + distanceCount_;
+      if (symbol < 16) {
+        takeBits(length);
+        lengths_[counter_++] = symbol;
+      } else {
+        uint8_t extraBits = symbol == 16 ? 2 : (symbol == 17 ? 3 : 7);
+        if (bitCount_ < length + extraBits) {
+          return false;
+        }
+        takeBits(length);
+        int repeat = takeBits(extraBits) + (symbol == 18 ? 11 : 3);
+        if ((symbol == 16 && counter_ == 0) || counter_ + repeat > total) {
+          fail();
+          return false;
+        }
+        uint8_t value = symbol == 16 ? lengths_[counter_ - 1] : 0;
+        while (repeat-- > 0) {
+          lengths_[counter_++] = value;
+        }
+      }
+      if (counter_ == total) {
+        // The code length code is not needed any more, its table becomes the
+        // distance table
+        if (lengths_[256] == 0
+            || !buildTree(literalCounts_, literalSymbols_, lengths_, literalCount_)
+            || !buildTree(distanceCounts_, distanceSymbols_, lengths_ + literalCount_, distanceCount_)) {
+          fail();
+          return false;
+        }
+        state_ = InflateState::Codes;
+      }
+      return true;
+    }
+    case InflateState::Codes: {
+      if (produced == outLength) {
+        return false;
+      }
+      uint8_t length;
+      int symbol = peekSymbol(literalCounts_, literalSymbols_, length);
+      if (symbol == NEED_BITS) {
+        return false;
+      }
+      if (symbol == INVALID_CODE || symbol > 285) {
+        fail();
+        return false;
+      }
+      if (symbol < 256) {
+        takeBits(length);
+        out[produced++] = symbol;
+        window_[windowPos_] = symbol;
+        windowPos_ = (windowPos_ + 1) & (INFLATE_WINDOW_SIZE - 1);
+        if (windowFill_ < INFLATE_WINDOW_SIZE) {
+          windowFill_++;
+        }
+      } else if (symbol == 256) {
+        takeBits(length);
+        endBlock();
+      } else {
+        uint8_t extraBits = LENGTH_EXTRA_BITS[symbol - 257];
+        if (bitCount_ < length + extraBits) {
+          return false;
+        }
+        takeBits(length);
+        remaining_ = LENGTH_BASES[symbol - 257] + takeBits(extraBits);
+        state_ = InflateState::Distance;
+      }
+      return true;
+    }
+    case InflateState::Distance: {
+      uint8_t length;
+      int symbol = peekSymbol(distanceCounts_, distanceSymbols_, length);
+      if (symbol == NEED_BITS) {
+        return false;
+      }
+      if (symbol == INVALID_CODE || symbol >= 30) {
+        fail();
+        return false;
+      }
+      uint8_t extraBits = DISTANCE_EXTRA_BITS[symbol];
+      if (bitCount_ < length + extraBits) {
+        return false;
+      }
+      takeBits(length);
+      distance_ = DISTANCE_BASES[symbol] + takeBits(extraBits);
+      if (distance_ > windowFill_) {
+        windowTooSmall_ = windowFill_ == INFLATE_WINDOW_SIZE;
+        fail();
+        return false;
+      }
+      state_ = InflateState::Copy;
+      return true;
+    }
+    case InflateState::Copy:
+    case InflateState::Stored:
+      if (produced == outLength) {
+        return false;
+      }
+      if (state_ == InflateState::Stored && bitCount_ < 8) {
+        return false;
+      }
+      while (remaining_ > 0 && produced < outLength) {
+        uint8_t value;
+        if (state_ == InflateState::Copy) {
+          value = window_[(windowPos_ - distance_) & (INFLATE_WINDOW_SIZE - 1)];
+        } else if (bitCount_ >= 8) {
+          value = takeBits(8);
+        } else {
+          // More of the stored block is in the input
+          return true;
+        }
+        out[produced++] = value;
+        window_[windowPos_] = value;
+        windowPos_ = (windowPos_ + 1) & (INFLATE_WINDOW_SIZE - 1);
+        if (windowFill_ < INFLATE_WINDOW_SIZE) {
+          windowFill_++;
+        }
+        remaining_--;
+      }
+      if (remaining_ == 0) {
+        if (state_ == InflateState::Copy) {
+          state_ = InflateState::Codes;
+        } else {
+          endBlock();
+        }
+      }
+      return true;
+    case InflateState::Trailer:
+      if (bitCount_ < 8) {
+        return false;
+      }
+      takeBits(8);
+      if (++counter_ == trailerLength_) {
+        state_ = InflateState::Done;
+      }
+      return true;
+    case InflateState::Done:
+    case InflateState::Error:
+      return false;
+  }
+  return false;
+}
@@ -0,0 +1,128 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// History kept for back references. Gzip allows up to 32 KB, and most
+// servers use all of it on a large answer. A stream that refers back further
+// than the window fails with isWindowTooSmall(). 15 handles all streams if
+// the heap can spare 32 KB.
+#define INFLATE_WINDOW_BITS 13
+#define INFLATE_WINDOW_SIZE (1 << INFLATE_WINDOW_BITS)
+
+#define INFLATE_MAX_BITS 15
+#define INFLATE_LITERAL_CODES 288
+#define INFLATE_DISTANCE_CODES 32
+
+enum class InflateFormat : uint8_t {
+  Gzip,
+  // HTTP deflate: zlib wrapped, or raw from servers that get it wrong
+  Deflate
+};
+
+enum class InflateState : uint8_t {
+  GzipHeader,
+  GzipExtraLength,
+  GzipExtra,
+  GzipName,
+  GzipComment,
+  GzipHeaderCrc,
+  ZlibHeader,
+  BlockHeader,
+  StoredLength,
+  Stored,
+  DynamicCounts,
+  CodeLengthCodes,
+  CodeLengths,
+  Codes,
+  Distance,
+  Copy,
+  Trailer,
+  Done,
+  Error
+};
+
+// Streaming gzip/deflate decoder. Input can be handed over in pieces of any
+// size, all state lives in the object: the back reference window and the
+// Huffman tables of the current block, about 9 KB with the default window.
+// Checksums are not verified, TCP already covers the transfer.
+class Inflater {
+  private:
+    InflateState state_;
+    uint32_t bitBuffer_;
+    uint8_t bitCount_;
+    bool final_;
+    bool windowTooSmall_;
+    uint8_t flags_;
+    uint8_t trailerLength_;
+    // Bytes of the current header field, lengths read or trailer bytes
+    uint16_t counter_;
+    uint16_t literalCount_;
+    uint16_t distanceCount_;
+    uint16_t codeLengthCount_;
+    // Bytes left of a stored block, a header field or a copy
+    uint16_t remaining_;
+    uint16_t distance_;
+
+    uint16_t literalCounts_[INFLATE_MAX_BITS + 1];
+    uint16_t literalSymbols_[INFLATE_LITERAL_CODES];
+    // Also holds the code length code while the tables are read
+    uint16_t distanceCounts_[INFLATE_MAX_BITS + 1];
+    uint16_t distanceSymbols_[INFLATE_DISTANCE_CODES];
+    uint8_t lengths_[INFLATE_LITERAL_CODES + INFLATE_DISTANCE_CODES];
+
+    uint8_t window_[INFLATE_WINDOW_SIZE];
+    uint16_t windowPos_;
+    // Bytes in the window, up to INFLATE_WINDOW_SIZE
+    uint16_t windowFill_;
+
+    bool step(uint8_t* out, size_t outLength, size_t& produced);
+    uint32_t takeBits(uint8_t count);
+    int peekSymbol(const uint16_t* counts, const uint16_t* symbols, uint8_t& length);
+    void nextGzipField();
+    void endBlock();
+    void fail();
+    static bool buildTree(uint16_t* counts, uint16_t* symbols, const uint8_t* lengths, int count);
+    void buildFixedTrees();
+
+  public:
+    Inflater();
+
+    void reset(InflateFormat format);
+
+    // Decodes from in into out until the input is used up or out is full.
+    // Sets consumed to the input bytes taken and returns the bytes written.
+    // Call again with an empty input while out comes back full.
+    size_t inflate(const uint8_t* in, size_t inLength, size_t& consumed, uint8_t* out, size_t outLength);
+
+    bool isDone();
+
+    bool hasError();
+
+    // True if the stream failed on a back reference beyond the window
+    bool isWindowTooSmall();
+};
@@ -0,0 +1,404 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "JsonTokenizer.h"
+
+JsonTokenizer::JsonTokenizer() {
+  reset();
+}
+
+void JsonTokenizer::setListener(JsonSpanListener* listener) {
+  listener_ = listener;
+}
+
+void JsonTokenizer::reset() {
+  state_ = State::StartDocument;
+  isKey_ = false;
+  discard_ = false;
+  depth_ = 0;
+  skipDepth_ = 0;
+  objectBits_ = 0;
+  bufferPos_ = 0;
+  buffer_[0] = '\0';
+}
+
+bool JsonTokenizer::isDone() {
+  return state_ == State::Done;
+}
+
+bool JsonTokenizer::hasError() {
+  return state_ == State::Error;
+}
+
+void JsonTokenizer::fail() {
+  Serial.println("JSON syntax error at depth " + String(depth_));
+  state_ = State::Error;
+}
+
+void JsonTokenizer::append(char c) {
+  if (!discard_ && bufferPos_ < JSON_TOKENIZER_BUFFER_LENGTH) {
+    buffer_[bufferPos_++] = c;
+  }
+}
+
+void JsonTokenizer::append(const char* data, size_t length) {
+  if (discard_) {
+    return;
+  }
+  size_t room = JSON_TOKENIZER_BUFFER_LENGTH - bufferPos_;
+  if (length > room) {
+    length = room;
+  }
+  memcpy(buffer_ + bufferPos_, data, length);
+  bufferPos_ += length;
+}
+
+void JsonTokenizer::appendUtf8(uint16_t codePoint) {
+  if (codePoint < 0x80) {
+    append(codePoint);
+  } else if (codePoint < 0x800) {
+    append(0xC0 | (codePoint >> 6));
+    append(0x80 | (codePoint & 0x3F));
+  } else {
+    append(0xE0 | (codePoint >> 12));
+    append(0x80 | ((codePoint >> 6) & 0x3F));
+    append(0x80 | (codePoint & 0x3F));
+  }
+}
+
+bool JsonTokenizer::inObject() {
+  return depth_ > 0 && (objectBits_ & (1UL << (depth_ - 1)));
+}
+
+void JsonTokenizer::push(bool isObject, char c) {
+  if (depth_ >= JSON_TOKENIZER_MAX_DEPTH) {
+    fail();
+    return;
+  }
+  if (isObject) {
+    objectBits_ |= 1UL << depth_;
+  } else {
+    objectBits_ &= ~(1UL << depth_);
+  }
+  depth_++;
+  discard_ = false;
+  if (isObject) {
+    listener_->startObject();
+    state_ = State::ObjectKey;
+  } else {
+    listener_->startArray();
+    state_ = State::Value;
+  }
+}
+
+void JsonTokenizer::pop(bool isObject) {
+  if (depth_ == 0 || inObject() != isObject) {
+    fail();
+    return;
+  }
+  depth_--;
+  if (isObject) {
+    listener_->endObject();
+  } else {
+    listener_->endArray();
+  }
+  if (depth_ == 0) {
+    state_ = State::Done;
+    listener_->endDocument();
+  } else {
+    state_ = State::AfterValue;
+  }
+}
+
+void JsonTokenizer::startValue(char c) {
+  bufferPos_ = 0;
+  if (discard_ && (c == '{' || c == '[')) {
+    // Nothing in an unwanted container is reported, so only the brackets
+    // and strings need tracking to find its end
+    skipDepth_ = 1;
+    state_ = State::Skip;
+    return;
+  }
+  switch (c) {
+    case '{':
+      push(true, c);
+      break;
+    case '[':
+      push(false, c);
+      break;
+    case '"':
+      isKey_ = false;
+      state_ = State::InString;
+      break;
+    case 't':
+    case 'f':
+    case 'n':
+      // Kept even when discarding, endLiteral() needs it to tell the type
+      buffer_[bufferPos_++] = c;
+      state_ = State::InLiteral;
+      break;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9')) {
+        append(c);
+        state_ = State::InNumber;
+      } else {
+        fail();
+      }
+  }
+}
+
+void JsonTokenizer::endString() {
+  buffer_[bufferPos_] = '\0';
+  if (isKey_) {
+    discard_ = !listener_->key(buffer_, bufferPos_);
+    state_ = State::AfterKey;
+  } else {
+    endScalar(JsonValueType::String);
+  }
+}
+
+void JsonTokenizer::endScalar(JsonValueType type) {
+  buffer_[bufferPos_] = '\0';
+  if (!discard_) {
+    listener_->value(buffer_, bufferPos_, type);
+  }
+  discard_ = false;
+  state_ = State::AfterValue;
+}
+
+void JsonTokenizer::endLiteral() {
+  JsonValueType type;
+  switch (buffer_[0]) {
+    case 't': type = JsonValueType::True; break;
+    case 'f': type = JsonValueType::False; break;
+    default: type = JsonValueType::Null; break;
+  }
+  endScalar(type);
+}
+
+void JsonTokenizer::afterValue(char c) {
+  switch (c) {
+    case ',':
+      state_ = inObject() ? State::ObjectKey : State::Value;
+      break;
+    case '}':
+      pop(true);
+      break;
+    case ']':
+      pop(false);
+      break;
+    default:
+      fail();
+  }
+}
+
+void JsonTokenizer::skip(char c) {
+  switch (state_) {
+    case State::SkipString:
+      if (c == '"') {
+        state_ = State::Skip;
+      } else if (c == '\\') {
+        state_ = State::SkipStringEscape;
+      }
+      break;
+    case State::SkipStringEscape:
+      state_ = State::SkipString;
+      break;
+    default:
+      switch (c) {
+        case '"':
+          state_ = State::SkipString;
+          break;
+        case '{':
+        case '[':
+          skipDepth_++;
+          break;
+        case '}':
+        case ']':
+          if (--skipDepth_ == 0) {
+            discard_ = false;
+            state_ = State::AfterValue;
+          }
+          break;
+      }
+  }
+}
+
+// Skips as many bytes as possible in one go and returns how many
+size_t JsonTokenizer::skipRun(const char* data, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    if (state_ == State::SkipString) {
+      while (i < length && data[i] != '"' && data[i] != '\\') {
+        i++;
+      }
+    } else if (state_ == State::Skip) {
+      while (i < length && data[i] != '"' && data[i] != '{' && data[i] != '[' && data[i] != '}' && data[i] != ']') {
+        i++;
+      }
+    }
+    if (i == length) {
+      break;
+    }
+    skip(data[i++]);
+    if (state_ == State::AfterValue) {
+      break;
+    }
+  }
+  return i;
+}
+
+void JsonTokenizer::parse(char c) {
+  if (listener_ == nullptr) {
+    return;
+  }
+  switch (state_) {
+    case State::Skip:
+    case State::SkipString:
+    case State::SkipStringEscape:
+      skip(c);
+      return;
+    case State::InString:
+      if (c == '"') {
+        endString();
+      } else if (c == '\\') {
+        state_ = State::StringEscape;
+      } else {
+        append(c);
+      }
+      return;
+    case State::StringEscape:
+      state_ = State::InString;
+      switch (c) {
+        case 'b': append('\b'); break;
+        case 'f': append('\f'); break;
+        case 'n': append('\n'); break;
+        case 'r': append('\r'); break;
+        case 't': append('\t'); break;
+        case 'u':
+          unicode_ = 0;
+          unicodeDigits_ = 0;
+          state_ = State::StringUnicode;
+          break;
+        default: append(c); break;
+      }
+      return;
+    case State::StringUnicode:
+      if (!isxdigit(c)) {
+        fail();
+        return;
+      }
+      unicode_ = (unicode_ << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+      if (++unicodeDigits_ == 4) {
+        appendUtf8(unicode_);
+        state_ = State::InString;
+      }
+      return;
+    case State::InNumber:
+      if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+') {
+        append(c);
+        return;
+      }
+      endScalar(JsonValueType::Number);
+      break;
+    case State::InLiteral:
+      if (c >= 'a' && c <= 'z') {
+        append(c);
+        return;
+      }
+      endLiteral();
+      break;
+    default:
+      break;
+  }
+
+  if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+    return;
+  }
+
+  switch (state_) {
+    case State::StartDocument:
+      if (c == '{' || c == '[') {
+        listener_->startDocument();
+        startValue(c);
+      }
+      // Anything before the document (e.g. left over header bytes) is skipped
+      break;
+    case State::Value:
+      if (c == ']' && !inObject()) {
+        pop(false);
+      } else {
+        startValue(c);
+      }
+      break;
+    case State::ObjectKey:
+      if (c == '"') {
+        bufferPos_ = 0;
+        isKey_ = true;
+        discard_ = false;
+        state_ = State::InString;
+      } else if (c == '}') {
+        pop(true);
+      } else {
+        fail();
+      }
+      break;
+    case State::AfterKey:
+      if (c == ':') {
+        isKey_ = false;
+        state_ = State::Value;
+      } else {
+        fail();
+      }
+      break;
+    case State::AfterValue:
+      afterValue(c);
+      break;
+    default:
+      break;
+  }
+}
+
+void JsonTokenizer::parse(const char* data, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    if (state_ == State::Skip || state_ == State::SkipString || state_ == State::SkipStringEscape) {
+      i += skipRun(data + i, length - i);
+      continue;
+    }
+    if (state_ == State::InString) {
+      // Plain string content is copied in runs instead of byte by byte
+      size_t start = i;
+      while (i < length && data[i] != '"' && data[i] != '\\') {
+        i++;
+      }
+      append(data + start, i - start);
+      if (i == length) {
+        break;
+      }
+    }
+    parse(data[i++]);
+  }
+}
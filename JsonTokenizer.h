@@ -0,0 +1,135 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Longest key or value text handed to the listener. Longer values are cut
+// off, the VirtualRadar fields we read are well below this.
+#define JSON_TOKENIZER_BUFFER_LENGTH 128
+#define JSON_TOKENIZER_MAX_DEPTH 20
+
+enum class JsonValueType : uint8_t {
+  String,
+  Number,
+  True,
+  False,
+  Null
+};
+
+// Listener for JsonTokenizer. Keys and values are passed as views into the
+// tokenizer's scratch buffer: they are NUL terminated, so atof()/strcmp()
+// work on them directly, but only valid during the call.
+class JsonSpanListener {
+  public:
+    virtual ~JsonSpanListener() {}
+
+    virtual void startDocument() = 0;
+
+    virtual void endDocument() = 0;
+
+    virtual void startObject() = 0;
+
+    virtual void endObject() = 0;
+
+    virtual void startArray() = 0;
+
+    virtual void endArray() = 0;
+
+    // Return false if the value of this key is not needed. It is then
+    // scanned without being copied or reported; for an object or array that
+    // includes everything nested in it.
+    virtual bool key(const char* key, size_t length) = 0;
+
+    virtual void value(const char* value, size_t length, JsonValueType type) = 0;
+};
+
+// Streaming JSON tokenizer that keeps all state in a fixed buffer, so parsing
+// a document does not touch the heap.
+class JsonTokenizer {
+  private:
+    enum class State : uint8_t {
+      StartDocument,
+      Value,
+      ObjectKey,
+      AfterKey,
+      AfterValue,
+      InString,
+      StringEscape,
+      StringUnicode,
+      InNumber,
+      InLiteral,
+      Skip,
+      SkipString,
+      SkipStringEscape,
+      Done,
+      Error
+    };
+
+    JsonSpanListener* listener_ = nullptr;
+    State state_ = State::StartDocument;
+    bool isKey_ = false;
+    bool discard_ = false;
+    uint8_t depth_ = 0;
+    // Open brackets of the container being skipped
+    uint16_t skipDepth_ = 0;
+    // One bit per nesting level, set for objects
+    uint32_t objectBits_ = 0;
+    char buffer_[JSON_TOKENIZER_BUFFER_LENGTH + 1];
+    uint16_t bufferPos_ = 0;
+    uint16_t unicode_ = 0;
+    uint8_t unicodeDigits_ = 0;
+
+    void append(char c);
+    void append(const char* data, size_t length);
+    void appendUtf8(uint16_t codePoint);
+    bool inObject();
+    void startValue(char c);
+    void endString();
+    void endScalar(JsonValueType type);
+    void endLiteral();
+    void afterValue(char c);
+    void push(bool isObject, char c);
+    void pop(bool isObject);
+    void skip(char c);
+    size_t skipRun(const char* data, size_t length);
+    void fail();
+
+  public:
+    JsonTokenizer();
+
+    void setListener(JsonSpanListener* listener);
+
+    void reset();
+
+    void parse(char c);
+
+    void parse(const char* data, size_t length);
+
+    bool isDone();
+
+    bool hasError();
+};
@@ -0,0 +1,151 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "Metrics.h"
+
+struct MetricInfo {
+  const char* name;
+  const char* unit;
+  uint32_t firstBound;
+};
+
+// In the order of Metric. Network times from 2 ms to 8 s, sizes from 256
+// bytes to 1 MB.
+static const MetricInfo METRIC_INFO[] = {
+  {"adsb.connect", "ms", 2},
+  {"adsb.first_byte", "ms", 2},
+  {"adsb.transfer", "ms", 2},
+  {"adsb.parse", "us", 64},
+  {"adsb.bytes", "bytes", 256},
+  {"adsb.aircraft", "aircraft", 1},
+  {"adsb.dropped", "aircraft", 1},
+  {"poll.interval", "ms", 256},
+  {"map.connect", "ms", 2},
+  {"map.first_byte", "ms", 2},
+  {"map.transfer", "ms", 2},
+  {"map.bytes", "bytes", 256},
+  {"locator.connect", "ms", 2},
+  {"locator.first_byte", "ms", 2},
+  {"locator.transfer", "ms", 2},
+  {"locator.bytes", "bytes", 256},
+  {"frame.draw", "ms", 2}
+};
+
+static const char* const COUNTER_NAMES[] = {
+  "adsb.polls",
+  "adsb.failures",
+  "adsb.requests",
+  "adsb.connects",
+  "map.downloads",
+  "map.failures",
+  "locator.requests",
+  "locator.failures"
+};
+
+static_assert(sizeof(METRIC_INFO) / sizeof(METRIC_INFO[0]) == (int) Metric::Count, "one entry per Metric");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == (int) Counter::Count, "one name per Counter");
+
+MetricsRegistry Metrics;
+
+void MetricsRegistry::record(Metric metric, uint32_t value) {
+  Histogram& histogram = histograms_[(int) metric];
+  uint8_t bucket = 0;
+  uint32_t bound = METRIC_INFO[(int) metric].firstBound;
+  while (bucket < METRIC_BUCKETS - 1 && value >= bound) {
+    bucket++;
+    bound <<= 1;
+  }
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.sum += value;
+  if (value > histogram.max) {
+    histogram.max = value;
+  }
+}
+
+void MetricsRegistry::count(Counter counter, uint32_t n) {
+  counters_[(int) counter] += n;
+}
+
+const Histogram& MetricsRegistry::getHistogram(Metric metric) {
+  return histograms_[(int) metric];
+}
+
+uint32_t MetricsRegistry::getCounter(Counter counter) {
+  return counters_[(int) counter];
+}
+
+uint32_t MetricsRegistry::getPercentile(Metric metric, uint8_t percent) {
+  const Histogram& histogram = histograms_[(int) metric];
+  if (histogram.count == 0) {
+    return 0;
+  }
+  uint32_t rank = ((uint64_t) histogram.count * percent + 99) / 100;
+  uint32_t seen = 0;
+  uint32_t bound = METRIC_INFO[(int) metric].firstBound;
+  for (uint8_t bucket = 0; bucket < METRIC_BUCKETS - 1; bucket++, bound <<= 1) {
+    seen += histogram.buckets[bucket];
+    if (seen >= rank) {
+      return bound < histogram.max ? bound : histogram.max;
+    }
+  }
+  return histogram.max;
+}
+
+const char* MetricsRegistry::getName(Metric metric) {
+  return METRIC_INFO[(int) metric].name;
+}
+
+const char* MetricsRegistry::getUnit(Metric metric) {
+  return METRIC_INFO[(int) metric].unit;
+}
+
+uint32_t MetricsRegistry::getFirstBound(Metric metric) {
+  return METRIC_INFO[(int) metric].firstBound;
+}
+
+// Bucket counts are labeled with their upper bound, the last one with the
+// lower bound and a '+'
+void MetricsRegistry::dump(Print& out) {
+  for (int i = 0; i < (int) Counter::Count; i++) {
+    out.printf("count %s %u\n", COUNTER_NAMES[i], counters_[i]);
+  }
+  for (int i = 0; i < (int) Metric::Count; i++) {
+    const Histogram& histogram = histograms_[i];
+    out.printf("hist %s %s n=%u sum=%llu max=%u", METRIC_INFO[i].name, METRIC_INFO[i].unit, histogram.count,
+               (unsigned long long) histogram.sum, histogram.max);
+    uint32_t bound = METRIC_INFO[i].firstBound;
+    for (uint8_t bucket = 0; bucket < METRIC_BUCKETS - 1; bucket++, bound <<= 1) {
+      out.printf(" %u:%u", bound, histogram.buckets[bucket]);
+    }
+    out.printf(" %u+:%u\n", bound >> 1, histogram.buckets[METRIC_BUCKETS - 1]);
+  }
+}
+
+void MetricsRegistry::reset() {
+  memset(histograms_, 0, sizeof(histograms_));
+  memset(counters_, 0, sizeof(counters_));
+}
@@ -0,0 +1,122 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+
+// Buckets per histogram. Bucket i counts the values below first << i, the
+// last one everything above.
+#define METRIC_BUCKETS 14
+
+// Histograms of the registry
+enum class Metric : uint8_t {
+  // ADS-B Exchange: per connection attempt, name lookup included
+  AdsbConnect,
+  // Per request, from sending it to the first byte of the answer, and from
+  // there to its end, parsing included
+  AdsbFirstByte,
+  AdsbTransfer,
+  // Per poll, the list and the trail requests that follow it together
+  AdsbParse,
+  AdsbBytes,
+  AdsbAircraft,
+  AdsbDropped,
+  // The interval PollScheduler chose after each poll
+  PollInterval,
+  MapConnect,
+  MapFirstByte,
+  MapTransfer,
+  MapBytes,
+  LocatorConnect,
+  LocatorFirstByte,
+  LocatorTransfer,
+  LocatorBytes,
+  // Time the sketch takes to draw a frame, map included
+  FrameDraw,
+  Count
+};
+
+enum class Counter : uint8_t {
+  AdsbPolls,
+  // Polls that did not read the list to its end
+  AdsbFailures,
+  AdsbRequests,
+  AdsbConnects,
+  MapDownloads,
+  MapFailures,
+  LocatorRequests,
+  LocatorFailures,
+  Count
+};
+
+struct Histogram {
+  uint32_t count;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[METRIC_BUCKETS];
+};
+
+// Counters and histograms of fetching and parsing, in a fixed block of
+// memory that is never freed or grown, about 1.3 KB. The network classes
+// record into the global Metrics. dump() writes them out, one line each,
+// for the serial console or a script that collects them:
+//
+//   hist adsb.first_byte ms n=120 sum=9800 max=412 2:0 4:3 ... 8192:0 8192+:0
+//   count adsb.polls 120
+//
+// The bucket bounds are fixed, so dumps of different devices add up.
+class MetricsRegistry {
+  private:
+    Histogram histograms_[(int) Metric::Count] = {};
+    uint32_t counters_[(int) Counter::Count] = {};
+
+  public:
+    void record(Metric metric, uint32_t value);
+
+    void count(Counter counter, uint32_t n = 1);
+
+    const Histogram& getHistogram(Metric metric);
+
+    uint32_t getCounter(Counter counter);
+
+    // Upper bound of the bucket that holds the given percentile, or the
+    // largest value seen if that is the last bucket
+    uint32_t getPercentile(Metric metric, uint8_t percent);
+
+    // Name and unit as dump() prints them
+    const char* getName(Metric metric);
+    const char* getUnit(Metric metric);
+
+    // Bound of the first bucket, the others double it
+    uint32_t getFirstBound(Metric metric);
+
+    void dump(Print& out);
+
+    void reset();
+};
+
+extern MetricsRegistry Metrics;
@@ -0,0 +1,476 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "ModeSClient.h"
+
+#define CPR_SCALE (1L << 17)
+#define MICRODEGREES_360 360000000LL
+
+// Remainder of each byte shifted through the generator 0x1FFF409
+static const uint32_t CRC_TABLE[256] PROGMEM = {
+  0x000000, 0xFFF409, 0x001C1B, 0xFFE812, 0x003836, 0xFFCC3F, 0x00242D, 0xFFD024,
+  0x00706C, 0xFF8465, 0x006C77, 0xFF987E, 0x00485A, 0xFFBC53, 0x005441, 0xFFA048,
+  0x00E0D8, 0xFF14D1, 0x00FCC3, 0xFF08CA, 0x00D8EE, 0xFF2CE7, 0x00C4F5, 0xFF30FC,
+  0x0090B4, 0xFF64BD, 0x008CAF, 0xFF78A6, 0x00A882, 0xFF5C8B, 0x00B499, 0xFF4090,
+  0x01C1B0, 0xFE35B9, 0x01DDAB, 0xFE29A2, 0x01F986, 0xFE0D8F, 0x01E59D, 0xFE1194,
+  0x01B1DC, 0xFE45D5, 0x01ADC7, 0xFE59CE, 0x0189EA, 0xFE7DE3, 0x0195F1, 0xFE61F8,
+  0x012168, 0xFED561, 0x013D73, 0xFEC97A, 0x01195E, 0xFEED57, 0x010545, 0xFEF14C,
+  0x015104, 0xFEA50D, 0x014D1F, 0xFEB916, 0x016932, 0xFE9D3B, 0x017529, 0xFE8120,
+  0x038360, 0xFC7769, 0x039F7B, 0xFC6B72, 0x03BB56, 0xFC4F5F, 0x03A74D, 0xFC5344,
+  0x03F30C, 0xFC0705, 0x03EF17, 0xFC1B1E, 0x03CB3A, 0xFC3F33, 0x03D721, 0xFC2328,
+  0x0363B8, 0xFC97B1, 0x037FA3, 0xFC8BAA, 0x035B8E, 0xFCAF87, 0x034795, 0xFCB39C,
+  0x0313D4, 0xFCE7DD, 0x030FCF, 0xFCFBC6, 0x032BE2, 0xFCDFEB, 0x0337F9, 0xFCC3F0,
+  0x0242D0, 0xFDB6D9, 0x025ECB, 0xFDAAC2, 0x027AE6, 0xFD8EEF, 0x0266FD, 0xFD92F4,
+  0x0232BC, 0xFDC6B5, 0x022EA7, 0xFDDAAE, 0x020A8A, 0xFDFE83, 0x021691, 0xFDE298,
+  0x02A208, 0xFD5601, 0x02BE13, 0xFD4A1A, 0x029A3E, 0xFD6E37, 0x028625, 0xFD722C,
+  0x02D264, 0xFD266D, 0x02CE7F, 0xFD3A76, 0x02EA52, 0xFD1E5B, 0x02F649, 0xFD0240,
+  0x0706C0, 0xF8F2C9, 0x071ADB, 0xF8EED2, 0x073EF6, 0xF8CAFF, 0x0722ED, 0xF8D6E4,
+  0x0776AC, 0xF882A5, 0x076AB7, 0xF89EBE, 0x074E9A, 0xF8BA93, 0x075281, 0xF8A688,
+  0x07E618, 0xF81211, 0x07FA03, 0xF80E0A, 0x07DE2E, 0xF82A27, 0x07C235, 0xF8363C,
+  0x079674, 0xF8627D, 0x078A6F, 0xF87E66, 0x07AE42, 0xF85A4B, 0x07B259, 0xF84650,
+  0x06C770, 0xF93379, 0x06DB6B, 0xF92F62, 0x06FF46, 0xF90B4F, 0x06E35D, 0xF91754,
+  0x06B71C, 0xF94315, 0x06AB07, 0xF95F0E, 0x068F2A, 0xF97B23, 0x069331, 0xF96738,
+  0x0627A8, 0xF9D3A1, 0x063BB3, 0xF9CFBA, 0x061F9E, 0xF9EB97, 0x060385, 0xF9F78C,
+  0x0657C4, 0xF9A3CD, 0x064BDF, 0xF9BFD6, 0x066FF2, 0xF99BFB, 0x0673E9, 0xF987E0,
+  0x0485A0, 0xFB71A9, 0x0499BB, 0xFB6DB2, 0x04BD96, 0xFB499F, 0x04A18D, 0xFB5584,
+  0x04F5CC, 0xFB01C5, 0x04E9D7, 0xFB1DDE, 0x04CDFA, 0xFB39F3, 0x04D1E1, 0xFB25E8,
+  0x046578, 0xFB9171, 0x047963, 0xFB8D6A, 0x045D4E, 0xFBA947, 0x044155, 0xFBB55C,
+  0x041514, 0xFBE11D, 0x04090F, 0xFBFD06, 0x042D22, 0xFBD92B, 0x043139, 0xFBC530,
+  0x054410, 0xFAB019, 0x05580B, 0xFAAC02, 0x057C26, 0xFA882F, 0x05603D, 0xFA9434,
+  0x05347C, 0xFAC075, 0x052867, 0xFADC6E, 0x050C4A, 0xFAF843, 0x051051, 0xFAE458,
+  0x05A4C8, 0xFA50C1, 0x05B8D3, 0xFA4CDA, 0x059CFE, 0xFA68F7, 0x0580E5, 0xFA74EC,
+  0x05D4A4, 0xFA20AD, 0x05C8BF, 0xFA3CB6, 0x05EC92, 0xFA189B, 0x05F089, 0xFA0480
+};
+
+// Latitudes in 1e-6 degrees below which the number of longitude zones NL is
+// 59, 58, ... 2. It is 1 from 87 degrees on.
+static const int32_t NL_LATITUDES[58] PROGMEM = {
+  10470471, 14828174, 18186264, 21029395, 23545045, 25829247, 27938987, 29911357,
+  31772097, 33539934, 35228996, 36850251, 38412419, 39922567, 41386518, 42809140,
+  44194550, 45546267, 46867333, 48160391, 49427764, 50671502, 51893425, 53095162,
+  54278175, 55443784, 56593188, 57727474, 58847638, 59954593, 61049178, 62132167,
+  63204275, 64266165, 65318453, 66361710, 67396468, 68423220, 69442426, 70454511,
+  71459865, 72458845, 73451774, 74438934, 75420563, 76396844, 77367895, 78333741,
+  79294282, 80249232, 81198013, 82139570, 83071994, 83991736, 84891662, 85755416,
+  86535370, 87000000
+};
+
+// Characters of the 6 bit call sign code, '#' marks unused codes
+static const char CALL_CHARACTERS[] = "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######";
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static int32_t positiveMod(int32_t a, int32_t b) {
+  int32_t r = a % b;
+  return r < 0 ? r + b : r;
+}
+
+static int numberOfLonZones(int32_t lat) {
+  if (lat < 0) {
+    lat = -lat;
+  }
+  // First threshold above lat
+  int low = 0;
+  int high = 58;
+  while (low < high) {
+    int middle = (low + high) / 2;
+    if (lat < (int32_t) pgm_read_dword(&NL_LATITUDES[middle])) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return 59 - low;
+}
+
+// count <= 24 bits from bit first on, counted from the MSB of data[0]
+static uint32_t readBits(const uint8_t* data, uint8_t first, uint8_t count) {
+  uint8_t last = first + count - 1;
+  uint32_t value = 0;
+  for (uint8_t i = first >> 3; i <= last >> 3; i++) {
+    value = value << 8 | data[i];
+  }
+  return (value >> (7 - (last & 7))) & ((1UL << count) - 1);
+}
+
+// Altitude of a 25 ft step code, 0 for the ground and below
+static uint16_t stepAltitude(uint32_t n) {
+  return n * 25 > 1000 ? n * 25 - 1000 : 0;
+}
+
+// Zones are numbered from 0 at the equator or meridian. Scales zone and
+// CPR value to 1e-6 degrees, from -180 to 180.
+static int32_t cprDegrees(int64_t zone, uint32_t cpr, int zones) {
+  int64_t scaled = zone * CPR_SCALE + cpr;
+  int64_t microdegrees = floorDiv(scaled * MICRODEGREES_360 + zones * CPR_SCALE / 2, zones * CPR_SCALE);
+  microdegrees = positiveMod((int32_t) (microdegrees % MICRODEGREES_360), (int32_t) MICRODEGREES_360);
+  return microdegrees >= MICRODEGREES_360 / 2 ? microdegrees - MICRODEGREES_360 : microdegrees;
+}
+
+// Zone of a reference that puts the CPR value closest to it
+static int64_t nearestZone(int32_t reference, uint32_t cpr, int zones) {
+  int64_t scaled = floorDiv((int64_t) reference * zones * CPR_SCALE, MICRODEGREES_360);
+  int64_t zone = floorDiv(scaled, CPR_SCALE);
+  int64_t fraction = scaled - zone * CPR_SCALE;
+  return zone + floorDiv(fraction - cpr + CPR_SCALE / 2, CPR_SCALE);
+}
+
+ModeSClient::ModeSClient(FeedMerger* merger, String host, uint16_t port, ModeSFormat format)
+    : FeedClient(merger, host, port, "Mode S") {
+  format_ = format;
+  memset(pending_, 0, sizeof(pending_));
+}
+
+void ModeSClient::resetFraming() {
+  frameLength_ = 0;
+  frameType_ = 0;
+  escaped_ = false;
+  nibble_ = -1;
+}
+
+void ModeSClient::parse(const char* data, size_t length, unsigned long now) {
+  stats_.bytes += length;
+  if (format_ == ModeSFormat::Beast) {
+    parseBeast(data, length, now);
+  } else {
+    parseAvr(data, length, now);
+  }
+}
+
+// 0x1A, type '1' (Mode A/C, 2 bytes), '2' (short) or '3' (long), 6 byte
+// timestamp, signal level, frame. A 0x1A followed by anything but 0x1A
+// starts the next frame, also in the middle of a broken one.
+void ModeSClient::parseBeast(const char* data, size_t length, unsigned long now) {
+  for (size_t i = 0; i < length; i++) {
+    uint8_t c = data[i];
+    if (escaped_) {
+      escaped_ = false;
+      if (c != 0x1A || frameType_ == 0) {
+        if (frameType_ != 0) {
+          stats_.ignored++;
+        }
+        frameType_ = c >= '1' && c <= '3' ? c : 0;
+        frameLength_ = 0;
+        continue;
+      }
+    } else if (c == 0x1A) {
+      escaped_ = true;
+      continue;
+    }
+    if (frameType_ == 0) {
+      continue;
+    }
+    frame_[frameLength_++] = c;
+    uint8_t length = frameType_ == '3' ? MODES_LONG_LENGTH : (frameType_ == '2' ? MODES_SHORT_LENGTH : 2);
+    if (frameLength_ == 7 + length) {
+      stats_.frames++;
+      if (frameType_ == '1') {
+        stats_.ignored++;
+      } else {
+        decodeFrame(frame_ + 7, length, now);
+      }
+      frameType_ = 0;
+    }
+  }
+}
+
+// "*" or "@" and a 12 digit timestamp, the frame in hex, ";". Anything
+// else ends the line as broken.
+void ModeSClient::parseAvr(const char* data, size_t length, unsigned long now) {
+  for (size_t i = 0; i < length; i++) {
+    char c = data[i];
+    int8_t value = -1;
+    if (c >= '0' && c <= '9') {
+      value = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      value = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      value = c - 'a' + 10;
+    }
+    if (value >= 0 && frameType_ != 0) {
+      if (nibble_ < 0) {
+        nibble_ = value;
+      } else if (frameLength_ < MODES_FRAME_BUFFER_LENGTH) {
+        frame_[frameLength_++] = nibble_ << 4 | value;
+        nibble_ = -1;
+      } else {
+        stats_.frames++;
+        stats_.ignored++;
+        frameType_ = 0;
+      }
+    } else if (c == '*' || c == '@') {
+      frameType_ = c;
+      frameLength_ = 0;
+      nibble_ = -1;
+    } else if (frameType_ != 0) {
+      stats_.frames++;
+      uint8_t skip = frameType_ == '@' ? 6 : 0;
+      uint8_t length = frameLength_ > skip ? frameLength_ - skip : 0;
+      if (c == ';' && nibble_ < 0 && (length == MODES_SHORT_LENGTH || length == MODES_LONG_LENGTH)) {
+        decodeFrame(frame_ + skip, length, now);
+      } else {
+        stats_.ignored++;
+      }
+      frameType_ = 0;
+    }
+  }
+}
+
+void ModeSClient::decodeFrame(const uint8_t* frame, uint8_t length, unsigned long now) {
+  uint8_t format = frame[0] >> 3;
+  // DF16 and up are long frames
+  if ((format >= 16) != (length == MODES_LONG_LENGTH)) {
+    stats_.ignored++;
+    return;
+  }
+  if (format == 17 || format == 18) {
+    // DF18 with CF 0 is ADS-B from a device without transponder that has an
+    // ICAO address. The other CF values are TIS-B and relayed messages.
+    if ((format == 18 && (frame[0] & 7) != 0) || checksum(frame, length) != 0) {
+      stats_.ignored++;
+      return;
+    }
+    uint32_t icao = (uint32_t) frame[1] << 16 | frame[2] << 8 | frame[3];
+    decodeExtendedSquitter(icao, frame + 4, now);
+  } else if (format == 4 || format == 5 || format == 20 || format == 21) {
+    decodeReply(frame, length, now);
+  } else {
+    stats_.ignored++;
+  }
+}
+
+uint32_t ModeSClient::checksum(const uint8_t* frame, uint8_t length) {
+  uint32_t crc = 0;
+  for (uint8_t i = 0; i < length - 3; i++) {
+    crc = ((crc << 8) ^ pgm_read_dword(&CRC_TABLE[(crc >> 16) ^ frame[i]])) & 0xFFFFFF;
+  }
+  return crc ^ ((uint32_t) frame[length - 3] << 16 | frame[length - 2] << 8 | frame[length - 1]);
+}
+
+// me is the 56 bit message of the squitter, its first 5 bits the type code
+void ModeSClient::decodeExtendedSquitter(uint32_t icao, const uint8_t* me, unsigned long now) {
+  uint8_t type = me[0] >> 3;
+  AircraftRecord record;
+  if (type >= 1 && type <= 4) {
+    // Identification: category, 8 characters of 6 bits
+    char call[AIRCRAFT_CALL_LENGTH];
+    uint8_t length = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      char c = CALL_CHARACTERS[readBits(me, 8 + i * 6, 6)];
+      if (c == '#') {
+        stats_.ignored++;
+        return;
+      }
+      call[i] = c;
+      if (c != ' ') {
+        length = i + 1;
+      }
+    }
+    if (!loadRecord(icao, record)) {
+      stats_.skipped++;
+      return;
+    }
+    memset(record.call, 0, AIRCRAFT_CALL_LENGTH);
+    memcpy(record.call, call, length < AIRCRAFT_CALL_LENGTH ? length : AIRCRAFT_CALL_LENGTH);
+    commitRecord(record, AIRCRAFT_IDENTITY, now);
+  } else if ((type >= 9 && type <= 18) || (type >= 20 && type <= 22)) {
+    // Airborne position: altitude, time flag, odd flag, latitude, longitude
+    CprPosition position = {readBits(me, 22, 17), readBits(me, 39, 17), readBits(me, 21, 1) != 0};
+    int32_t lat;
+    int32_t lon;
+    if (loadRecord(icao, record)) {
+      decodeLocalCpr(position, record.lat, record.lon, lat, lon);
+    } else if (!decodeFirstPosition(icao, position, now, lat, lon)) {
+      stats_.skipped++;
+      return;
+    }
+    record.lat = lat;
+    record.lon = lon;
+    uint8_t fields = AIRCRAFT_POSITION | AIRCRAFT_ALTITUDE;
+    uint32_t altitude = readBits(me, 8, 12);
+    if (type >= 20) {
+      // GNSS height in meters
+      record.altitude = altitude * 3.2808f + 0.5f;
+    } else if (altitude & 0x10) {
+      // 25 ft steps with the Q bit taken out
+      record.altitude = stepAltitude((altitude & 0xFE0) >> 1 | (altitude & 0xF));
+    } else {
+      // Gillham coded, which only old transponders use; it is not decoded
+      fields = AIRCRAFT_POSITION;
+    }
+    commitRecord(record, fields, now);
+  } else if (type == 19) {
+    uint8_t subtype = me[0] & 7;
+    if (subtype < 1 || subtype > 4) {
+      stats_.ignored++;
+      return;
+    }
+    if (!loadRecord(icao, record)) {
+      stats_.skipped++;
+      return;
+    }
+    // Subtypes 2 and 4 are for supersonic aircraft, in 4 kn steps
+    int scale = subtype == 2 || subtype == 4 ? 4 : 1;
+    if (subtype <= 2) {
+      // Ground speed as east-west and north-south components, 0 if unknown
+      int32_t east = readBits(me, 14, 10);
+      int32_t north = readBits(me, 25, 10);
+      if (east > 0 && north > 0) {
+        east = (east - 1) * scale * (readBits(me, 13, 1) ? -1 : 1);
+        north = (north - 1) * scale * (readBits(me, 24, 1) ? -1 : 1);
+        record.speed = sqrt((float) (east * east + north * north)) + 0.5f;
+        float heading = atan2((float) east, (float) north) * 1800 / (float) PI;
+        record.heading = (heading < 0 ? heading + 3600 : heading) + 0.5f;
+        record.heading %= 3600;
+      }
+    } else {
+      // Heading and airspeed, which is the best there is
+      if (readBits(me, 13, 1)) {
+        record.heading = readBits(me, 14, 10) * 3600 / 1024;
+      }
+      uint32_t airspeed = readBits(me, 25, 10);
+      if (airspeed > 0) {
+        record.speed = (airspeed - 1) * scale;
+      }
+    }
+    commitRecord(record, AIRCRAFT_VELOCITY, now);
+  } else {
+    // Surface positions, status and operational messages
+    stats_.ignored++;
+  }
+}
+
+// Altitude (DF4, DF20) and identity (DF5, DF21) replies. Their parity is
+// the CRC of the frame xor the address, so a frame with bit errors looks
+// like one of an unknown aircraft.
+void ModeSClient::decodeReply(const uint8_t* frame, uint8_t length, unsigned long now) {
+  AircraftRecord record;
+  if (!loadRecord(checksum(frame, length), record)) {
+    stats_.ignored++;
+    return;
+  }
+  uint32_t code = readBits(frame, 19, 13);
+  uint8_t format = frame[0] >> 3;
+  uint8_t fields = 0;
+  if (format == 4 || format == 20) {
+    // Like the 12 bit altitude with the M bit, set for meters, in front of Q
+    if ((code & 0x40) == 0 && (code & 0x10) != 0) {
+      fields = AIRCRAFT_ALTITUDE;
+      record.altitude = stepAltitude((code & 0x1F80) >> 2 | (code & 0x20) >> 1 | (code & 0xF));
+    }
+  } else {
+    // C1 A1 C2 A2 C4 A4 X B1 D1 B2 D2 B4 D4
+    uint16_t a = (code >> 7 & 1) << 2 | (code >> 9 & 1) << 1 | (code >> 11 & 1);
+    uint16_t b = (code >> 1 & 1) << 2 | (code >> 3 & 1) << 1 | (code >> 5 & 1);
+    uint16_t c = (code >> 8 & 1) << 2 | (code >> 10 & 1) << 1 | (code >> 12 & 1);
+    uint16_t d = (code & 1) << 2 | (code >> 2 & 1) << 1 | (code >> 4 & 1);
+    record.squawk = a * 1000 + b * 100 + c * 10 + d;
+    fields = AIRCRAFT_IDENTITY;
+  }
+  commitRecord(record, fields, now);
+}
+
+// The first position of an aircraft. Halves of a pair wait in pending_,
+// which forgets the aircraft that sent the least recently when it is full.
+boolean ModeSClient::decodeFirstPosition(uint32_t icao, const CprPosition& position, unsigned long now,
+                                         int32_t& lat, int32_t& lon) {
+  PendingPosition* entry = nullptr;
+  PendingPosition* oldest = &pending_[0];
+  auto age = [now](const PendingPosition& p) {
+    return now - (p.millis[0] - p.millis[1] < 0x80000000UL ? p.millis[0] : p.millis[1]);
+  };
+  for (int i = 0; i < MODES_PENDING_POSITIONS; i++) {
+    PendingPosition& candidate = pending_[i];
+    if (candidate.halves != 0 && candidate.icao == icao) {
+      entry = &candidate;
+      break;
+    }
+    if (oldest->halves != 0 && (candidate.halves == 0 || age(candidate) > age(*oldest))) {
+      oldest = &candidate;
+    }
+  }
+  if (!entry) {
+    entry = oldest;
+    entry->icao = icao;
+    entry->halves = 0;
+    entry->millis[0] = entry->millis[1] = now;
+  }
+  uint8_t half = position.odd ? 1 : 0;
+  entry->halves |= 1 << half;
+  entry->millis[half] = now;
+  entry->lat[half] = position.lat;
+  entry->lon[half] = position.lon;
+
+  boolean decoded = false;
+  if (entry->halves == 3 && now - entry->millis[1 - half] <= MODES_PAIR_MILLIS) {
+    CprPosition even = {entry->lat[0], entry->lon[0], false};
+    CprPosition odd = {entry->lat[1], entry->lon[1], true};
+    decoded = decodeGlobalCpr(even, odd, position.odd, lat, lon);
+  }
+  if (!decoded) {
+    decodeLocalCpr(position, lround(center_.lat * 1e6), lround(center_.lon * 1e6), lat, lon);
+    decoded = distanceTo(lat, lon) <= MODES_LOCAL_RANGE_KM * 100;
+  }
+  if (decoded) {
+    entry->halves = 0;
+  }
+  return decoded;
+}
+
+boolean ModeSClient::decodeGlobalCpr(const CprPosition& even, const CprPosition& odd, boolean oddIsNewer,
+                                     int32_t& lat, int32_t& lon) {
+  // Latitude zone index, 60 even and 59 odd zones
+  int32_t j = floorDiv(59 * (int32_t) even.lat - 60 * (int32_t) odd.lat + CPR_SCALE / 2, CPR_SCALE);
+  int32_t evenLat = cprDegrees(positiveMod(j, 60), even.lat, 60);
+  int32_t oddLat = cprDegrees(positiveMod(j, 59), odd.lat, 59);
+  // cprDegrees() folds 270 to 360 degrees to the southern hemisphere, what
+  // lies in between comes from a broken pair
+  if (evenLat < -90000000 || evenLat > 90000000 || oddLat < -90000000 || oddLat > 90000000) {
+    return false;
+  }
+  int zones = numberOfLonZones(evenLat);
+  if (zones != numberOfLonZones(oddLat)) {
+    return false;
+  }
+  lat = oddIsNewer ? oddLat : evenLat;
+  int lonZones = zones - (oddIsNewer ? 1 : 0);
+  lonZones = lonZones > 1 ? lonZones : 1;
+  int32_t m = floorDiv((int64_t) even.lon * (zones - 1) - (int64_t) odd.lon * zones + CPR_SCALE / 2, CPR_SCALE);
+  lon = cprDegrees(positiveMod(m, lonZones), oddIsNewer ? odd.lon : even.lon, lonZones);
+  return true;
+}
+
+void ModeSClient::decodeLocalCpr(const CprPosition& position, int32_t refLat, int32_t refLon,
+                                 int32_t& lat, int32_t& lon) {
+  int latZones = position.odd ? 59 : 60;
+  lat = cprDegrees(nearestZone(refLat, position.lat, latZones), position.lat, latZones);
+  int lonZones = numberOfLonZones(lat) - (position.odd ? 1 : 0);
+  lonZones = lonZones > 1 ? lonZones : 1;
+  lon = cprDegrees(nearestZone(refLon, position.lon, lonZones), position.lon, lonZones);
+}
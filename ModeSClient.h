@@ -0,0 +1,132 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "FeedClient.h"
+
+// Long frames are 14 bytes, short ones 7. The Beast timestamp and signal
+// level, or the AVR timestamp, come in front.
+#define MODES_LONG_LENGTH 14
+#define MODES_SHORT_LENGTH 7
+#define MODES_FRAME_BUFFER_LENGTH (7 + MODES_LONG_LENGTH)
+// Aircraft waiting for the second half of an even/odd position pair
+#define MODES_PENDING_POSITIONS 16
+// The two halves of a pair must be this close, they are ambiguous further
+// than 180 NM apart
+#define MODES_PAIR_MILLIS 10000
+// A single position of an aircraft not seen before is decoded relative to
+// the center if it comes out this close to it, in km. The result is
+// unambiguous up to 333 km from the center less this.
+#define MODES_LOCAL_RANGE_KM 150
+
+// How the receiver frames the Mode S messages
+enum class ModeSFormat : uint8_t {
+  // dump1090 --net-ro-port (30002): "*8D4840D6202CC371C32CE0576098;" lines,
+  // or with "@" and a 6 byte timestamp in front of the hex
+  Avr,
+  // dump1090 --net-bo-port (30005): binary, 0x1A type timestamp signal frame
+  // with 0x1A escaped as 0x1A 0x1A
+  Beast
+};
+
+// An even or odd airborne position, latitude and longitude as 17 bit CPR
+// values
+struct CprPosition {
+  uint32_t lat;
+  uint32_t lon;
+  boolean odd;
+};
+
+// Decodes the raw Mode S frames a local receiver such as dump1090 or a Beast
+// sends, instead of the SBS-1 text it makes of them, so the CRC is checked
+// here and nothing but the receiver is needed.
+//
+// Extended squitters (DF17, DF18 with an ICAO address) carry the call sign,
+// airborne positions and velocities. Their CRC must come out as zero; frames
+// with bit errors are dropped rather than corrected. Altitude and squawk
+// replies (DF4, DF5, DF20, DF21) have the address folded into the parity,
+// so they are only trusted for aircraft the store already knows.
+//
+// Positions are CPR encoded. A known aircraft's position is decoded relative
+// to its last fix. The first one needs an even and an odd position within
+// MODES_PAIR_MILLIS for a global decode, or must lie within
+// MODES_LOCAL_RANGE_KM of the center. Surface positions are ignored.
+class ModeSClient : public FeedClient {
+  private:
+    struct PendingPosition {
+      uint32_t icao;
+      // Bit 0 set if the even half is there, bit 1 for the odd one
+      uint8_t halves;
+      unsigned long millis[2];
+      uint32_t lat[2];
+      uint32_t lon[2];
+    };
+
+    ModeSFormat format_;
+    uint8_t frame_[MODES_FRAME_BUFFER_LENGTH];
+    uint8_t frameLength_ = 0;
+    // Beast: the type byte, 0 while looking for the next frame.
+    // AVR: the line's first character, 0 while skipping a bad line.
+    uint8_t frameType_ = 0;
+    boolean escaped_ = false;
+    // AVR: the high nibble waiting for its low one
+    int8_t nibble_ = -1;
+    PendingPosition pending_[MODES_PENDING_POSITIONS];
+
+    void parseBeast(const char* data, size_t length, unsigned long now);
+    void parseAvr(const char* data, size_t length, unsigned long now);
+    void decodeExtendedSquitter(uint32_t icao, const uint8_t* me, unsigned long now);
+    void decodeReply(const uint8_t* frame, uint8_t length, unsigned long now);
+    boolean decodeFirstPosition(uint32_t icao, const CprPosition& position, unsigned long now,
+                                int32_t& lat, int32_t& lon);
+
+  protected:
+    virtual void resetFraming();
+
+  public:
+    ModeSClient(FeedMerger* merger, String host, uint16_t port, ModeSFormat format);
+
+    virtual void parse(const char* data, size_t length, unsigned long now);
+
+    // Decodes a frame of MODES_SHORT_LENGTH or MODES_LONG_LENGTH bytes
+    void decodeFrame(const uint8_t* frame, uint8_t length, unsigned long now);
+
+    // CRC-24 remainder of the frame. Zero for an intact extended squitter,
+    // the address of the aircraft for an intact reply.
+    static uint32_t checksum(const uint8_t* frame, uint8_t length);
+
+    // Global decode of an even/odd pair, in 1e-6 degrees. The newer position
+    // is returned. False if the pair straddles a longitude zone boundary.
+    static boolean decodeGlobalCpr(const CprPosition& even, const CprPosition& odd, boolean oddIsNewer,
+                                   int32_t& lat, int32_t& lon);
+
+    // Decodes a position relative to a reference within 180 NM of it
+    static void decodeLocalCpr(const CprPosition& position, int32_t refLat, int32_t refLon,
+                               int32_t& lat, int32_t& lon);
+};
@@ -30,15 +30,16 @@ See more at https://blog.squix.org
 #include "PlaneSpotter.h"
 #include <SPI.h>
 
-PlaneSpotter::PlaneSpotter(TFT_ILI9341_ESP* tft, GeoMap* geoMap) {
+PlaneSpotter::PlaneSpotter(TFT_ILI9341_ESP* tft, GeoMap* geoMap, StringPool* strings) {
   tft_ = tft;
   geoMap_ = geoMap;
+  strings_ = strings;
 }
 
 void PlaneSpotter::copyProgmemToSpiffs(const uint8_t *data, unsigned int length, String filename) {
   fs::File f = SPIFFS.open(filename, "w+");
   uint8_t c;
-  for(int i = 0; i < length; i++) {
+  for(unsigned int i = 0; i < length; i++) {
     c = pgm_read_byte(data + i);
     f.write(c);
   }
@@ -47,7 +48,6 @@ void PlaneSpotter::copyProgmemToSpiffs(const uint8_t *data, unsigned int length,
 
 
 void PlaneSpotter::drawSPIFFSJpeg(String filename, int32_t xpos, int32_t ypos) {
-  Serial.println(filename);
   JpegDec.decodeFile(filename);
   //jpegInfo();
   renderJPEG(xpos, ypos);
@@ -56,18 +56,16 @@ void PlaneSpotter::drawSPIFFSJpeg(String filename, int32_t xpos, int32_t ypos) {
 void PlaneSpotter::renderJPEG(int32_t xpos, int32_t ypos) {
 
   uint8_t  *pImg;
-  uint32_t mcu_w = JpegDec.MCUWidth;
-  uint32_t mcu_h = JpegDec.MCUHeight;
+  int32_t mcu_w = JpegDec.MCUWidth;
+  int32_t mcu_h = JpegDec.MCUHeight;
   int32_t max_x = JpegDec.width;
   int32_t max_y = JpegDec.height;
 
-  uint32_t min_w = min(mcu_w, max_x % mcu_w);
-  uint32_t min_h = min(mcu_h, max_y % mcu_h);
+  int32_t min_w = min(mcu_w, max_x % mcu_w);
+  int32_t min_h = min(mcu_h, max_y % mcu_h);
 
-  uint32_t win_w = mcu_w;
-  uint32_t win_h = mcu_h;
-
-  uint32_t drawTime = millis();
+  int32_t win_w = mcu_w;
+  int32_t win_h = mcu_h;
 
   max_x += xpos;
   max_y += ypos;
@@ -95,13 +93,14 @@ void PlaneSpotter::renderJPEG(int32_t xpos, int32_t ypos) {
   }
 }
 
-void PlaneSpotter::drawAircraftHistory(Aircraft aircraft, AircraftHistory history) {
+void PlaneSpotter::drawAircraftHistory(const Aircraft& aircraft, const AircraftHistory& history) {
     Coordinates lastCoordinates;
     lastCoordinates.lat = aircraft.lat;
     lastCoordinates.lon = aircraft.lon;
-    for (int j = 0; j < min(history.counter, MAX_HISTORY); j++) {
+    AircraftHistoryCursor cursor = history.begin();
+    AircraftPosition position;
+    while (history.next(cursor, position)) {
 
-      AircraftPosition position = history.positions[j];
       Coordinates coordinates = position.coordinates;
       CoordinatesPixel p1 = geoMap_->convertToPixel(coordinates);
 
@@ -111,11 +110,10 @@ void PlaneSpotter::drawAircraftHistory(Aircraft aircraft, AircraftHistory histor
       tft_->drawLine(p1.x+1, p1.y+1, p2.x+1, p2.y+1, color);
 
       lastCoordinates = coordinates;
-      // Serial.println(String(j) + ". " + String(historyIndex) + ". " + String(coordinates.lat) + ", " + String(coordinates.lon));
     }
 }
 
-void PlaneSpotter::drawPlane(Aircraft aircraft, boolean isSpecial) {
+void PlaneSpotter::drawPlane(const Aircraft& aircraft, boolean isSpecial) {
   Coordinates coordinates;
   coordinates.lon = aircraft.lon;
   coordinates.lat = aircraft.lat;  
@@ -142,13 +140,12 @@ void PlaneSpotter::drawPlane(Aircraft aircraft, boolean isSpecial) {
   }
 }
 
-String PlaneSpotter::drawInfoBox(Aircraft closestAircraft) {
+String PlaneSpotter::drawInfoBox(const Aircraft& closestAircraft) {
   int line1 = geoMap_->getMapHeight() + 10;
   int line2 = geoMap_->getMapHeight() + 20;
-  int line3 = geoMap_->getMapHeight() + 30;
   int right = tft_->width();
   //tft_->fillRect(0, geoMap_->getMapHeight(), tft_->width(), tft_->height() - geoMap_->getMapHeight(), TFT_BLACK);
-  if (closestAircraft.call != "") {
+  if (closestAircraft.call[0] != '\0') {
 
     int xwidth = tft_->textWidth("ABC1234XY", GFXFONT ) + 12;
     tft_->setTextPadding(xwidth);
@@ -158,7 +155,7 @@ String PlaneSpotter::drawInfoBox(Aircraft closestAircraft) {
 
     tft_->setTextPadding(320 - xwidth);
     tft_->setTextDatum(BR_DATUM);
-    tft_->drawString(closestAircraft.aircraftType, right - 2, line1, GFXFONT );
+    tft_->drawString(strings_->get(closestAircraft.aircraftType), right - 2, line1, GFXFONT );
     
     tft_->setTextColor(TFT_YELLOW, TFT_BLACK);
     tft_->setTextDatum(BL_DATUM);
@@ -183,13 +180,28 @@ String PlaneSpotter::drawInfoBox(Aircraft closestAircraft) {
     tft_->setTextPadding(xwidth);
     tft_->drawString("Hdg: " + String(closestAircraft.heading, 0), right - xwidth, line2, GFXFONT );
   
-    if (closestAircraft.fromShort != "" && closestAircraft.toShort != "") {
-    return "From: " + closestAircraft.fromShort + "=>" + closestAircraft.toShort;
+    String fromShort = getAirportShortName(closestAircraft.from);
+    String toShort = getAirportShortName(closestAircraft.to);
+    if (fromShort != "" && toShort != "") {
+    return "From: " + fromShort + "=>" + toShort;
     }
   }
   return "";
 }
 
+// "LSZH Zurich" => " Zurich", also with the rest of the VRS name after a comma
+String PlaneSpotter::getAirportShortName(uint16_t airport) {
+  String name = strings_->get(airport);
+  int end = name.indexOf(',');
+  if (end < 0) {
+    end = name.length();
+  }
+  if (end <= 4) {
+    return "";
+  }
+  return name.substring(4, end);
+}
+
 void PlaneSpotter::jpegInfo() {
 
   // Print information extracted from the JPEG file
@@ -58,23 +58,26 @@ enum TextAlignment {
 
 class PlaneSpotter {
   public:
-    PlaneSpotter(TFT_ILI9341_ESP* tft, GeoMap* geoMap);
+    PlaneSpotter(TFT_ILI9341_ESP* tft, GeoMap* geoMap, StringPool* strings);
     void copyProgmemToSpiffs(const uint8_t *data, unsigned int length, String filename);
 
     void drawSPIFFSJpeg(String filename, int xpos, int ypos);
     void renderJPEG(int xpos, int ypos);
 
-    void drawPlane(Aircraft aircraft, boolean isSpecial);
+    void drawPlane(const Aircraft& aircraft, boolean isSpecial);
 
-    String drawInfoBox(Aircraft closestAircraft);
+    String drawInfoBox(const Aircraft& closestAircraft);
 
-    void drawAircraftHistory(Aircraft aircraft, AircraftHistory history);
+    void drawAircraftHistory(const Aircraft& aircraft, const AircraftHistory& history);
 
     void jpegInfo(void);
 
   private:
     TFT_ILI9341_ESP* tft_;
     GeoMap* geoMap_;
+    StringPool* strings_;
+
+    String getAirportShortName(uint16_t airport);
     // Shape of the plane
     // The points are defined as degree on a circle, the first array are the degrees, 
     // the second the radius of the circle
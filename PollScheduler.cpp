@@ -0,0 +1,103 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "PollScheduler.h"
+
+PollScheduler::PollScheduler(FeedMerger* merger, uint8_t source) {
+  merger_ = merger;
+  source_ = source;
+}
+
+void PollScheduler::setMetersPerPixel(float metersPerPixel) {
+  metersPerPixel_ = metersPerPixel;
+}
+
+boolean PollScheduler::isDue(unsigned long now) {
+  return !polled_ || now - finishedMillis_ >= interval_;
+}
+
+void PollScheduler::pollFinished(boolean success, unsigned long fetchMillis, unsigned long now) {
+  polled_ = true;
+  finishedMillis_ = now;
+  fetchMillis_ = stats_.polls == 0 ? fetchMillis : (fetchMillis_ * 3 + fetchMillis) / 4;
+  stats_.polls++;
+
+  uint32_t interval;
+  if (success) {
+    failures_ = 0;
+    interval = trafficInterval();
+  } else {
+    stats_.failures++;
+    if (failures_ < 8) {
+      failures_++;
+    }
+    uint32_t backoff = (uint32_t) POLL_BACKOFF_MILLIS << (failures_ - 1);
+    if (backoff > POLL_MAX_BACKOFF_MILLIS) {
+      backoff = POLL_MAX_BACKOFF_MILLIS;
+    }
+    interval = backoff + random(backoff / 4);
+  }
+  if (interval < fetchMillis_ * POLL_FETCH_FACTOR) {
+    interval = fetchMillis_ * POLL_FETCH_FACTOR;
+  }
+  interval_ = interval;
+  stats_.intervalSum += interval;
+  stats_.lastInterval = interval;
+  Metrics.record(Metric::PollInterval, interval);
+}
+
+// Drift of a turning aircraft after t seconds is about v * w * t^2 / 2 for
+// v in pixels per second and w in radians per second
+uint32_t PollScheduler::trafficInterval() {
+  AircraftStore* store = merger_->getStore();
+  uint16_t fastest = 0;
+  for (int i = 0; i < store->getNumberOfAircrafts(); i++) {
+    if (store->getSource(i) != source_) {
+      continue;
+    }
+    uint16_t speed = store->getRecord(i).speed;
+    if (speed > fastest) {
+      fastest = speed;
+    }
+  }
+  if (fastest == 0) {
+    // No aircraft of the source, or none moving. New ones show up at most
+    // this late.
+    return POLL_MAX_MILLIS;
+  }
+  float pixelsPerSecond = fastest * 0.5144f / metersPerPixel_;
+  float seconds = sqrt(2.0f * POLL_DRIFT_PIXELS / (pixelsPerSecond * POLL_TURN_RATE / 1000.0f));
+  uint32_t interval = seconds * 1000;
+  return interval < POLL_MIN_MILLIS ? POLL_MIN_MILLIS : (interval > POLL_MAX_MILLIS ? POLL_MAX_MILLIS : interval);
+}
+
+unsigned long PollScheduler::getInterval() {
+  return interval_;
+}
+
+PollStats PollScheduler::getStats() {
+  return stats_;
+}
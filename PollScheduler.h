@@ -0,0 +1,101 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "FeedMerger.h"
+#include "Metrics.h"
+
+// Bounds of the time between two polls. Extrapolated positions stop moving
+// after MAX_EXTRAPOLATION_MILLIS, the longest interval stays below it.
+#define POLL_MIN_MILLIS 1000
+#define POLL_MAX_MILLIS 8000
+// How far an extrapolated aircraft may drift from its true position before
+// the next poll, if it turns at POLL_TURN_RATE. The track filter needs a few
+// fixes to follow a turn, so the shown positions are off by several times
+// this, see bench_schedule.
+#define POLL_DRIFT_PIXELS 0.25
+// Standard rate turn, 3 degrees per second, in milliradians per second
+#define POLL_TURN_RATE 52
+// The interval is at least this many times the time a poll takes, which
+// keeps the network busy for at most a quarter of the time
+#define POLL_FETCH_FACTOR 3
+// First interval after a failed poll, doubling with every further failure
+#define POLL_BACKOFF_MILLIS 4000
+#define POLL_MAX_BACKOFF_MILLIS 120000
+
+struct PollStats {
+  uint32_t polls;
+  uint32_t failures;
+  // Sum of the chosen intervals, for the mean
+  uint64_t intervalSum;
+  uint32_t lastInterval;
+};
+
+// Decides when to poll ADS-B Exchange next. A dead reckoned aircraft that
+// turns drifts from its shown position with the square of the time since
+// the fix, and the faster it crosses the map, the more pixels that is. The
+// interval is the longest that keeps the fastest aircraft within
+// POLL_DRIFT_PIXELS, so a quiet sky or a zoomed out map is polled less
+// often than a busy approach path. A slow server stretches the interval,
+// failed polls back off exponentially with some jitter, so a fleet of
+// spotters doesn't retry in step.
+//
+// Only aircraft whose position comes from the polled source count, those a
+// receiver tracks are fresh anyway.
+class PollScheduler {
+  private:
+    FeedMerger* merger_;
+    uint8_t source_;
+    float metersPerPixel_ = 100;
+    // Smoothed duration of a poll
+    uint32_t fetchMillis_ = 0;
+    uint8_t failures_ = 0;
+    uint32_t interval_ = POLL_MIN_MILLIS;
+    unsigned long finishedMillis_ = 0;
+    boolean polled_ = false;
+    PollStats stats_ = {};
+
+    uint32_t trafficInterval();
+
+  public:
+    PollScheduler(FeedMerger* merger, uint8_t source);
+
+    // Scale of the map, see GeoMap::getMetersPerPixel()
+    void setMetersPerPixel(float metersPerPixel);
+
+    // True if the next poll should start. The first one is due right away.
+    boolean isDue(unsigned long now);
+
+    // Call when a poll ended, with the time it took from start to end.
+    // Chooses the next interval from the aircraft the poll brought.
+    void pollFinished(boolean success, unsigned long fetchMillis, unsigned long now);
+
+    unsigned long getInterval();
+
+    PollStats getStats();
+};
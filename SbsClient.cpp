@@ -0,0 +1,150 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#include "SbsClient.h"
+
+// Fields of a MSG line
+#define SBS_TYPE 1
+#define SBS_ICAO 4
+#define SBS_CALL 10
+#define SBS_ALTITUDE 11
+#define SBS_SPEED 12
+#define SBS_TRACK 13
+#define SBS_LAT 14
+#define SBS_LON 15
+#define SBS_SQUAWK 17
+
+SbsClient::SbsClient(FeedMerger* merger, String host, uint16_t port)
+    : FeedClient(merger, host, port, "SBS") {
+}
+
+void SbsClient::resetFraming() {
+  lineLength_ = 0;
+  lineTooLong_ = false;
+}
+
+void SbsClient::parse(const char* data, size_t length, unsigned long now) {
+  stats_.bytes += length;
+  const char* end = data + length;
+  while (data < end) {
+    const char* newline = (const char*) memchr(data, '\n', end - data);
+    const char* stop = newline ? newline : end;
+    size_t count = stop - data;
+    if (lineLength_ + count > SBS_LINE_LENGTH) {
+      lineTooLong_ = true;
+    } else {
+      memcpy(line_ + lineLength_, data, count);
+      lineLength_ += count;
+    }
+    if (!newline) {
+      break;
+    }
+    if (lineLength_ > 0 && line_[lineLength_ - 1] == '\r') {
+      lineLength_--;
+    }
+    line_[lineLength_] = '\0';
+    stats_.frames++;
+    if (lineTooLong_) {
+      stats_.ignored++;
+    } else {
+      parseLine(now);
+    }
+    lineLength_ = 0;
+    lineTooLong_ = false;
+    data = newline + 1;
+  }
+}
+
+// MSG,type,session,aircraft,icao,flight,generated date,time,logged date,time,
+// call,altitude,speed,track,lat,lon,vertical rate,squawk,alert,emergency,spi,
+// on ground. Only the fields of the message type are set.
+void SbsClient::parseLine(unsigned long now) {
+  char* fields[SBS_FIELDS];
+  int count = 0;
+  char* field = line_;
+  while (count < SBS_FIELDS) {
+    fields[count++] = field;
+    char* comma = strchr(field, ',');
+    if (!comma) {
+      break;
+    }
+    *comma = '\0';
+    field = comma + 1;
+  }
+  int type = count > SBS_ICAO && strcmp(fields[0], "MSG") == 0 ? atoi(fields[SBS_TYPE]) : 0;
+  char* icaoEnd;
+  // Addresses that are not ICAO, such as TIS-B ones starting with '~', fail
+  uint32_t icao = type > 0 ? strtoul(fields[SBS_ICAO], &icaoEnd, 16) : 0;
+  if (type < 1 || type > 8 || icao == 0 || *icaoEnd != '\0') {
+    stats_.ignored++;
+    return;
+  }
+  for (int i = count; i < SBS_FIELDS; i++) {
+    fields[i] = line_ + lineLength_;
+  }
+
+  boolean hasPosition = fields[SBS_LAT][0] != '\0' && fields[SBS_LON][0] != '\0';
+  AircraftRecord record;
+  if (!loadRecord(icao, record) && !hasPosition) {
+    stats_.skipped++;
+    return;
+  }
+
+  uint8_t changed = hasPosition ? AIRCRAFT_POSITION : 0;
+  if (fields[SBS_CALL][0] != '\0') {
+    changed |= AIRCRAFT_IDENTITY;
+    // Padded with spaces to 8 characters
+    size_t length = strlen(fields[SBS_CALL]);
+    while (length > 0 && fields[SBS_CALL][length - 1] == ' ') {
+      length--;
+    }
+    memset(record.call, 0, AIRCRAFT_CALL_LENGTH);
+    memcpy(record.call, fields[SBS_CALL], length < AIRCRAFT_CALL_LENGTH ? length : AIRCRAFT_CALL_LENGTH);
+  }
+  if (fields[SBS_ALTITUDE][0] != '\0') {
+    changed |= AIRCRAFT_ALTITUDE;
+    long altitude = atol(fields[SBS_ALTITUDE]);
+    record.altitude = altitude < 0 ? 0 : (altitude > UINT16_MAX ? UINT16_MAX : altitude);
+  }
+  if (fields[SBS_SPEED][0] != '\0') {
+    changed |= AIRCRAFT_VELOCITY;
+    record.speed = atof(fields[SBS_SPEED]) + 0.5;
+  }
+  if (fields[SBS_TRACK][0] != '\0') {
+    changed |= AIRCRAFT_VELOCITY;
+    record.heading = atof(fields[SBS_TRACK]) * 10 + 0.5;
+  }
+  if (hasPosition) {
+    record.lat = lround(atof(fields[SBS_LAT]) * 1e6);
+    record.lon = lround(atof(fields[SBS_LON]) * 1e6);
+  }
+  if (fields[SBS_SQUAWK][0] != '\0') {
+    changed |= AIRCRAFT_IDENTITY;
+    record.squawk = atoi(fields[SBS_SQUAWK]);
+  }
+
+  commitRecord(record, changed, now);
+}
@@ -0,0 +1,58 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "FeedClient.h"
+
+// Lines longer than this are dropped. dump1090 writes about 100 characters.
+#define SBS_LINE_LENGTH 160
+#define SBS_FIELDS 22
+
+// Reads the SBS-1 (BaseStation) text feed a local receiver such as dump1090
+// sends on port 30003, one message per line.
+//
+// Identification messages carry the call sign, airborne positions altitude
+// and position, velocities speed and track. An aircraft is added with its
+// first position; messages before that are skipped, the receiver repeats
+// them within seconds.
+class SbsClient : public FeedClient {
+  private:
+    char line_[SBS_LINE_LENGTH + 1];
+    uint8_t lineLength_ = 0;
+    boolean lineTooLong_ = false;
+
+    void parseLine(unsigned long now);
+
+  protected:
+    virtual void resetFraming();
+
+  public:
+    SbsClient(FeedMerger* merger, String host, uint16_t port);
+
+    virtual void parse(const char* data, size_t length, unsigned long now);
+};
@@ -0,0 +1,161 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#include "StringPool.h"
+
+// FNV-1a folded to 16 bits
+uint16_t StringPool::hash(const char* value, size_t length) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ (uint8_t) value[i]) * 16777619UL;
+  }
+  return (h >> 16) ^ h;
+}
+
+uint16_t StringPool::intern(const char* value, size_t length) {
+  if (length == 0) {
+    return NO_STRING;
+  }
+  if (length > 255) {
+    length = 255;
+  }
+  uint16_t h = hash(value, length);
+  for (int b = h & (STRING_POOL_BUCKETS - 1); buckets_[b] != 0; b = (b + 1) & (STRING_POOL_BUCKETS - 1)) {
+    int slot = buckets_[b] - 1;
+    if (hashes_[slot] == h && lengths_[slot] == length && memcmp(arena_ + offsets_[slot], value, length) == 0) {
+      references_[slot]++;
+      lastUsed_[slot] = ++clock_;
+      return slot + 1;
+    }
+  }
+
+  int slot = freeSlot();
+  while (slot < 0 || used_ + length + 1 > STRING_POOL_SIZE) {
+    if (!evict()) {
+      overflows_++;
+      return NO_STRING;
+    }
+    slot = freeSlot();
+  }
+  offsets_[slot] = used_;
+  lengths_[slot] = length;
+  hashes_[slot] = h;
+  references_[slot] = 1;
+  lastUsed_[slot] = ++clock_;
+  memcpy(arena_ + used_, value, length);
+  arena_[used_ + length] = '\0';
+  used_ += length + 1;
+  count_++;
+  insertBucket(slot);
+  return slot + 1;
+}
+
+int StringPool::freeSlot() {
+  for (int i = 0; i < MAX_POOL_STRINGS; i++) {
+    if (lengths_[i] == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void StringPool::insertBucket(int slot) {
+  int b = hashes_[slot] & (STRING_POOL_BUCKETS - 1);
+  while (buckets_[b] != 0) {
+    b = (b + 1) & (STRING_POOL_BUCKETS - 1);
+  }
+  buckets_[b] = slot + 1;
+}
+
+// Drops the least recently used unreferenced string and closes its gap in
+// the arena. Ids of the other strings don't change, only their offsets.
+boolean StringPool::evict() {
+  int victim = -1;
+  uint16_t oldest = 0;
+  for (int i = 0; i < MAX_POOL_STRINGS; i++) {
+    uint16_t age = clock_ - lastUsed_[i];
+    if (lengths_[i] != 0 && references_[i] == 0 && (victim < 0 || age > oldest)) {
+      victim = i;
+      oldest = age;
+    }
+  }
+  if (victim < 0) {
+    return false;
+  }
+  uint16_t start = offsets_[victim];
+  uint16_t size = lengths_[victim] + 1;
+  memmove(arena_ + start, arena_ + start + size, used_ - start - size);
+  used_ -= size;
+  lengths_[victim] = 0;
+  count_--;
+  evictions_++;
+
+  memset(buckets_, 0, sizeof(buckets_));
+  for (int i = 0; i < MAX_POOL_STRINGS; i++) {
+    if (lengths_[i] != 0) {
+      if (offsets_[i] > start) {
+        offsets_[i] -= size;
+      }
+      insertBucket(i);
+    }
+  }
+  return true;
+}
+
+void StringPool::retain(uint16_t id) {
+  if (id != NO_STRING && id <= MAX_POOL_STRINGS && lengths_[id - 1] != 0) {
+    references_[id - 1]++;
+    lastUsed_[id - 1] = ++clock_;
+  }
+}
+
+void StringPool::release(uint16_t id) {
+  if (id != NO_STRING && id <= MAX_POOL_STRINGS && references_[id - 1] > 0) {
+    references_[id - 1]--;
+  }
+}
+
+const char* StringPool::get(uint16_t id) {
+  if (id == NO_STRING || id > MAX_POOL_STRINGS || lengths_[id - 1] == 0) {
+    return "";
+  }
+  return arena_ + offsets_[id - 1];
+}
+
+uint16_t StringPool::getNumberOfStrings() {
+  return count_;
+}
+
+uint16_t StringPool::getUsedBytes() {
+  return used_;
+}
+
+uint16_t StringPool::getNumberOfEvictions() {
+  return evictions_;
+}
+
+uint16_t StringPool::getNumberOfOverflows() {
+  return overflows_;
+}
@@ -0,0 +1,96 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Room for 2.5 texts and 32 bytes per aircraft of MAX_AIRCRAFTS: the airports
+// of a busy sky mostly differ, models and operators repeat. 102 aircraft of
+// the diverse mock feed take 156 strings in 2594 bytes. AircraftStore checks
+// that the store doesn't outgrow it. At most 255, the buckets hold slot + 1.
+#define MAX_POOL_STRINGS 255
+#define STRING_POOL_SIZE 3584
+// Hash table size, a power of two at least twice MAX_POOL_STRINGS
+#define STRING_POOL_BUCKETS 512
+
+// Id of the empty string, also returned when the pool is full
+#define NO_STRING 0
+
+// Fixed arena of NUL terminated strings. Equal strings are stored once and
+// referred to by a small integer id, so airports, operators and aircraft
+// models that repeat in every poll cost two bytes per aircraft.
+//
+// Ids are reference counted. intern() hands out a reference that the caller
+// gives back with release(); an id stays valid while it is referenced.
+// Unreferenced strings stay cached until the arena runs out of room, then
+// the least recently used of them is evicted.
+class StringPool {
+  private:
+    char arena_[STRING_POOL_SIZE];
+    uint16_t used_ = 0;
+    // Per slot, the id of a slot is its index + 1. A length of 0 marks a
+    // free slot.
+    uint16_t offsets_[MAX_POOL_STRINGS];
+    uint8_t lengths_[MAX_POOL_STRINGS] = {};
+    uint16_t hashes_[MAX_POOL_STRINGS];
+    uint16_t references_[MAX_POOL_STRINGS] = {};
+    uint16_t lastUsed_[MAX_POOL_STRINGS];
+    // Open addressing with linear probing, holds slot + 1, 0 if empty
+    uint8_t buckets_[STRING_POOL_BUCKETS] = {};
+    uint16_t count_ = 0;
+    uint16_t clock_ = 0;
+    uint16_t evictions_ = 0;
+    uint16_t overflows_ = 0;
+
+    static uint16_t hash(const char* value, size_t length);
+    int freeSlot();
+    boolean evict();
+    void insertBucket(int slot);
+
+  public:
+    // Returns a referenced id for the string, adding it if needed. Returns
+    // NO_STRING for an empty string or if nothing can be evicted, which
+    // getNumberOfOverflows() counts.
+    uint16_t intern(const char* value, size_t length);
+
+    // Adds a reference to an id that is already referenced
+    void retain(uint16_t id);
+
+    // Gives back a reference from intern() or retain(), NO_STRING is ignored
+    void release(uint16_t id);
+
+    // Returns the string for an id, "" for NO_STRING
+    const char* get(uint16_t id);
+
+    uint16_t getNumberOfStrings();
+
+    uint16_t getUsedBytes();
+
+    uint16_t getNumberOfEvictions();
+
+    // Strings that didn't fit since the start
+    uint16_t getNumberOfOverflows();
+};
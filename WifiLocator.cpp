@@ -57,13 +57,18 @@ void WifiLocator::updateLocation(String bssid) {
 }
 
 void WifiLocator::doUpdate(String query) {
-    JsonStreamingParser parser;
+  JsonTokenizer parser;
   parser.setListener(this);
   WiFiClient client;
   const int httpPort = 80;
+  Metrics.count(Counter::LocatorRequests);
   // http://api.mylnikov.org/geolocation/wifi?v=1.1&data=open&bssid=00:0C:42:1F:65:E9
-  if (!client.connect("api.mylnikov.org", httpPort)) {
+  unsigned long connectStart = millis();
+  boolean connected = client.connect("api.mylnikov.org", httpPort);
+  Metrics.record(Metric::LocatorConnect, millis() - connectStart);
+  if (!connected) {
     Serial.println("connection failed");
+    Metrics.count(Counter::LocatorFailures);
     return;
   }
  
@@ -74,53 +79,95 @@ void WifiLocator::doUpdate(String query) {
   client.print(String("GET ") + query + " HTTP/1.1\r\n" +
                "Host: api.mylnikov.org\r\n" +
                "Connection: close\r\n\r\n");
+  unsigned long sentMillis = millis();
   int retryCounter = 0;
   while(!client.available()) {
     delay(1000);
     retryCounter++;
     if (retryCounter > 10) {
+      Metrics.count(Counter::LocatorFailures);
       return;
     }
   }
+  // In steps of the second the loop above waits
+  unsigned long firstByteMillis = millis();
+  Metrics.record(Metric::LocatorFirstByte, firstByteMillis - sentMillis);
 
-  int pos = 0;
-  boolean isBody = false;
-  char c;
+  HttpResponseParser response;
+  char buffer[HTTP_READ_BUFFER_LENGTH];
 
-  int size = 0;
   client.setNoDelay(false);
-  while(client.connected()) {
-    while((size = client.available()) > 0) {
-      c = client.read();
-      if (c == '{' || c == '[') {
-        Serial.print(c);
-        isBody = true;
+  uint32_t received = 0;
+  unsigned long dataMillis = millis();
+  while(!response.isDone() && !parser.isDone()) {
+    int size = client.available();
+    if (size <= 0) {
+      if (!client.connected()) {
+        break;
       }
-      if (isBody) {
-        parser.parse(c);
+      if (millis() - dataMillis > HTTP_IDLE_TIMEOUT_MILLIS) {
+        Serial.println("Timeout waiting for the server");
+        break;
       }
+      yield();
+      continue;
     }
-  }  
+    size = client.read((uint8_t*) buffer, min(size, HTTP_READ_BUFFER_LENGTH));
+    if (size <= 0) {
+      continue;
+    }
+    dataMillis = millis();
+    received += size;
+    size_t bodyLength = response.parse(buffer, size);
+    if (response.isInBody() && !response.isSuccess()) {
+      Serial.println("HTTP error " + String(response.getStatusCode()));
+      break;
+    }
+    parser.parse(buffer, bodyLength);
+  }
+  client.stop();
+  if (response.isSuccess() && parser.isDone()) {
+    Metrics.record(Metric::LocatorTransfer, dataMillis - firstByteMillis);
+    Metrics.record(Metric::LocatorBytes, received);
+  } else {
+    Metrics.count(Counter::LocatorFailures);
+  }
 }
 
-void WifiLocator::key(String key) {
-  key_ = key;
+bool WifiLocator::key(const char* key, size_t length) {
+  if (strcmp(key, "result") == 0) {
+    key_ = LocatorKey::Result;
+  } else if (strcmp(key, "data") == 0) {
+    key_ = LocatorKey::Data;
+  } else if (strcmp(key, "lat") == 0) {
+    key_ = LocatorKey::Lat;
+  } else if (strcmp(key, "lon") == 0) {
+    key_ = LocatorKey::Lon;
+  } else if (strcmp(key, "range") == 0) {
+    key_ = LocatorKey::Range;
+  } else {
+    key_ = LocatorKey::Unknown;
+  }
+  return key_ != LocatorKey::Unknown;
 }
 
-void WifiLocator::value(String value) {
-  if (key_ == "result") {
-    result_ = value;
-  }
-  if (key_ == "lat") {
-    lat_ = value;
+void WifiLocator::value(const char* value, size_t length, JsonValueType type) {
+  switch (key_) {
+    case LocatorKey::Result:
+      result_ = value;
+      break;
+    case LocatorKey::Lat:
+      lat_ = value;
+      break;
+    case LocatorKey::Lon:
+      lon_ = value;
+      break;
+    case LocatorKey::Range:
+      range_ = value;
+      break;
+    default:
+      break;
   }
-  if (key_ == "lon") {
-    lon_ = value;
-  }
-  if (key_ == "range") {
-    range_ = value;
-  }
-  Serial.println("Key " + key_ + ", value: " + value);
 }
 
 String WifiLocator::getLon() {
@@ -139,10 +186,6 @@ String WifiLocator::getResult() {
   return result_;
 }
 
-void WifiLocator::whitespace(char c) {
-  
-}
-
 void WifiLocator::startDocument() {
   
 }
@@ -29,20 +29,30 @@ http://www.adp-gmbh.ch/cpp/common/base64.html
 
 #pragma once
 
-#include <JsonListener.h>
-#include <JsonStreamingParser.h>
 #include <ESP8266WiFi.h>
 #include <WiFiClient.h>
+#include "JsonTokenizer.h"
+#include "HttpResponseParser.h"
+#include "Metrics.h"
 
 #define MAX_SSIDS 5
 
 #define min(a,b) ((a)<(b)?(a):(b))
 
-class WifiLocator: public JsonListener {
+enum class LocatorKey : uint8_t {
+  Unknown,
+  Result,
+  Data,
+  Lat,
+  Lon,
+  Range
+};
+
+class WifiLocator: public JsonSpanListener {
   private:
     String lon_;
     String lat_;
-    String key_;
+    LocatorKey key_ = LocatorKey::Unknown;
     String result_;
     String range_;
     String base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -65,13 +75,11 @@ class WifiLocator: public JsonListener {
 
     String getResult();
 
-    virtual void whitespace(char c);
-
     virtual void startDocument();
 
-    virtual void key(String key);
+    virtual bool key(const char* key, size_t length);
 
-    virtual void value(String value);
+    virtual void value(const char* value, size_t length, JsonValueType type);
 
     virtual void endArray();
 
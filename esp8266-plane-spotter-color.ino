@@ -59,16 +59,33 @@ Adapter by Bodmer to use latest JPEGDecoder library.
 
 #include "artwork.h"
 #include "AdsbExchangeClient.h"
+#include "SbsClient.h"
+#include "ModeSClient.h"
+#include "PollScheduler.h"
+#include "Metrics.h"
 #include "GeoMap.h"
 
 // Initialize the TFT
 TFT_ILI9341_ESP tft = TFT_ILI9341_ESP();
 
 WifiLocator locator;
-AdsbExchangeClient adsbClient;
+StringPool stringPool;
+AircraftStore aircraftStore(&stringPool);
+// When there are more aircraft than fit, emergencies, watchlisted aircraft
+// (addToWatchlist(0x4B1805) etc.) and low flying aircraft are kept first
+PriorityScore priorityScore;
+// All feeds go through the merger, the display reads from it
+FeedMerger feedMerger(&aircraftStore);
+AdsbExchangeClient adsbClient(&feedMerger);
+// The local receiver if one is set, null to poll ADS-B Exchange only.
+// Created in setup() so an unused one takes no RAM.
+FeedClient* receiver = nullptr;
+int receiverBytes = 0;
+// When to poll ADS-B Exchange next
+PollScheduler pollScheduler(&feedMerger, adsbClient.getSource());
 GeoMap geoMap(MapProvider::Google, GOOGLE_API_KEY, MAP_WIDTH, MAP_HEIGHT);
 //GeoMap geoMap(MapProvider::MapQuest, MAP_QUEST_API_KEY, MAP_WIDTH, MAP_HEIGHT);
-PlaneSpotter planeSpotter(&tft, &geoMap);
+PlaneSpotter planeSpotter(&tft, &geoMap, &stringPool);
 
 
 Coordinates mapCenter;
@@ -78,20 +95,48 @@ Coordinates mapCenter;
 // lat=47.424341887&lng=8.56877803&fDstL=0&fDstU=10&fAltL=0&fAltL=1500&fAltU=10000
 //const String QUERY_STRING = "fDstL=0&fDstU=20&fAltL=0&fAltL=1000&fAltU=10000";
 // airport zürich is on 1410ft => hide landed airplanes
-const String QUERY_STRING = "fAltL=1500&trFmt=sa";
+// Trails are built from the positions of each poll. Add &trFmt=sa to download
+// the full trails with every poll instead.
+const String QUERY_STRING = "fAltL=1500";
 
 void downloadCallback(String filename, uint32_t bytesDownloaded, uint32_t bytesTotal);
+void drawFrame(unsigned long now);
 ProgressCallback _downloadCallback = downloadCallback;
 
 Coordinates northWestBound;
 Coordinates southEastBound;
 
+// When the running update started, the last frame was drawn and the metrics
+// were dumped
+unsigned long pollStartMillis = 0;
+unsigned long frameMillis = 0;
+unsigned long metricsMillis = 0;
+// Redrawing the map takes a good part of FRAME_INTERVAL_MILLIS on the
+// ESP8266. Frames are spaced twice as far as the last one took to draw, so
+// the feeds get at least as much time as the display.
+unsigned long frameInterval = FRAME_INTERVAL_MILLIS;
+
 
 void setup() {
 
   // Start serial communication
   Serial.begin(115200);
   Serial.println("Free Heap: " + String(ESP.getFreeHeap()));
+  aircraftStore.setScore(&priorityScore);
+  if (strlen(SBS_HOST) > 0) {
+    receiver = new SbsClient(&feedMerger, SBS_HOST, SBS_PORT);
+    receiverBytes = sizeof(SbsClient);
+  } else if (strlen(MODES_HOST) > 0) {
+    receiver = new ModeSClient(&feedMerger, MODES_HOST, MODES_PORT, MODES_FORMAT);
+    receiverBytes = sizeof(ModeSClient);
+  }
+  // A server that compresses with an 8 KB window sends about a quarter of the
+  // bytes, for 9 KB of heap for the inflater. gzip's default 32 KB window
+  // doesn't fit, the first answer would be fetched twice.
+  //adsbClient.setCompression(true);
+  aircraftStore.printMemoryReport(sizeof(tft) + sizeof(locator) + sizeof(priorityScore) + sizeof(feedMerger)
+      + sizeof(adsbClient) + receiverBytes + sizeof(pollScheduler) + sizeof(geoMap) + sizeof(planeSpotter)
+      + sizeof(Metrics));
   // The LED pin needs to set HIGH
   // Use this pin to save energy
 //  pinMode(LED_PIN, D8);
@@ -143,30 +188,68 @@ void setup() {
 
   northWestBound = geoMap.convertToCoordinates({0,0});
   southEastBound = geoMap.convertToCoordinates({MAP_WIDTH, MAP_HEIGHT});
+  if (receiver) {
+    receiver->setCenter(mapCenter);
+  }
+  pollScheduler.setMetersPerPixel(geoMap.getMetersPerPixel());
   tft.fillRect(0, geoMap.getMapHeight(), tft.width(), tft.height() - geoMap.getMapHeight(), TFT_BLACK);
 }
 
 
 void loop() {
   //Serial.println("Heap: " + String(ESP.getFreeHeap()));
-  adsbClient.updateVisibleAircraft(QUERY_STRING + "&lat=" + String(mapCenter.lat, 6) + "&lng=" + String(mapCenter.lon, 6) + "&fNBnd=" + String(northWestBound.lat, 9) + "&fWBnd=" + String(northWestBound.lon, 9) + "&fSBnd=" + String(southEastBound.lat, 9) + "&fEBnd=" + String(southEastBound.lon, 9));
+  // The fetch runs in steps between the frames, the display keeps moving
+  // while the answer trickles in
+  if (receiver) {
+    receiver->poll();
+  }
+  if (!receiver || ADSB_EXCHANGE_WITH_RECEIVER) {
+    if (adsbClient.isUpdating()) {
+      if (!adsbClient.poll()) {
+        unsigned long now = millis();
+        pollScheduler.pollFinished(adsbClient.getLastFetchStats().complete, now - pollStartMillis, now);
+      }
+    } else if (pollScheduler.isDue(millis())) {
+      pollStartMillis = millis();
+      adsbClient.startUpdate(QUERY_STRING + "&lat=" + String(mapCenter.lat, 6) + "&lng=" + String(mapCenter.lon, 6) + "&fNBnd=" + String(northWestBound.lat, 9) + "&fWBnd=" + String(northWestBound.lon, 9) + "&fSBnd=" + String(southEastBound.lat, 9) + "&fEBnd=" + String(southEastBound.lon, 9));
+    }
+  }
 
-  Aircraft closestAircraft = adsbClient.getClosestAircraft(mapCenter.lat, mapCenter.lon);
+  if (millis() - frameMillis >= frameInterval) {
+    frameMillis = millis();
+    drawFrame(frameMillis);
+    unsigned long drawMillis = millis() - frameMillis;
+    Metrics.record(Metric::FrameDraw, drawMillis);
+    frameInterval = drawMillis * 2 > FRAME_INTERVAL_MILLIS ? drawMillis * 2 : FRAME_INTERVAL_MILLIS;
+  }
+
+  boolean dumpMetrics = Serial.available() > 0 && Serial.read() == 'm';
+  if (METRICS_DUMP_INTERVAL_MILLIS > 0 && millis() - metricsMillis >= METRICS_DUMP_INTERVAL_MILLIS) {
+    metricsMillis = millis();
+    dumpMetrics = true;
+  }
+  if (dumpMetrics) {
+    Metrics.dump(Serial);
+  }
+}
+
+void drawFrame(unsigned long now) {
+  int closest = feedMerger.findClosestAircraft();
 
-  long startMillis = millis();
   planeSpotter.drawSPIFFSJpeg(geoMap.getMapName(), 0, 0);
-  Serial.println(String(millis()-startMillis) + "ms for Jpeg drawing");
   //uint32_t pplot = millis();
-  for (int i = 0; i < adsbClient.getNumberOfAircrafts(); i++) {
-    Aircraft aircraft = adsbClient.getAircraft(i);
-    AircraftHistory history = adsbClient.getAircraftHistory(i);
-    planeSpotter.drawAircraftHistory(aircraft, history);
-    planeSpotter.drawPlane(aircraft, aircraft.call == closestAircraft.call);
+  for (int i = 0; i < feedMerger.getNumberOfAircrafts(); i++) {
+    Aircraft aircraft = feedMerger.getAircraft(i, now);
+    const AircraftHistory* history = feedMerger.getAircraftHistory(i);
+    if (history) {
+      planeSpotter.drawAircraftHistory(aircraft, *history);
+    }
+    planeSpotter.drawPlane(aircraft, i == closest);
   }
   //Serial.print("Time to plot planes is: "); Serial.println(millis() - pplot);
   
-  if (adsbClient.getNumberOfAircrafts()) {
-    String fromString = planeSpotter.drawInfoBox(closestAircraft);
+  if (closest >= 0) {
+    String fromString = planeSpotter.drawInfoBox(feedMerger.getAircraft(closest));
     // Use print stream so the line wraps (tft_->print does not work, kludge is to get the String returned so we can use the print class!)
     tft.setCursor(0, 228);
     tft.setTextColor(TFT_GREEN, TFT_BLACK);
@@ -182,10 +265,7 @@ void loop() {
   // Draw center of map
   CoordinatesPixel p = geoMap.convertToPixel(mapCenter);
   tft.fillCircle(p.x, p.y, 2, TFT_BLUE); 
-
-  Serial.println(String(millis()-startMillis) + "ms for all drawing");
-  delay(2000);
-
+  feedMerger.frameDrawn(now);
 }
 
 
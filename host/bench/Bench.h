@@ -0,0 +1,80 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Small helpers shared by the host benchmarks.
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+#include "HostHeap.h"
+
+// Reads a recorded response. A leading HTTP header (as saved by curl -i) is
+// dropped so only the body reaches the parser.
+inline std::vector<char> benchLoadBody(const char* path) {
+  HostHeapPause pause;
+  std::vector<char> data;
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "cannot open %s\n", path);
+    exit(1);
+  }
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  if (data.size() > 5 && memcmp(data.data(), "HTTP/", 5) == 0) {
+    for (size_t i = 3; i < data.size(); i++) {
+      if (memcmp(&data[i - 3], "\r\n\r\n", 4) == 0) {
+        data.erase(data.begin(), data.begin() + i + 1);
+        break;
+      }
+    }
+  }
+  return data;
+}
+
+inline int benchCount(const std::vector<char>& data, const char* needle) {
+  size_t length = strlen(needle);
+  int count = 0;
+  for (size_t i = 0; i + length <= data.size(); i++) {
+    if (memcmp(&data[i], needle, length) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+inline uint64_t benchNanos() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+inline const char* benchBaseName(const char* path) {
+  const char* slash = strrchr(path, '/');
+  return slash ? slash + 1 : path;
+}
@@ -0,0 +1,270 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Replays raw Mode S captures through ModeSClient::parse() in the pieces the
+// socket reads of FeedClient::poll() have, and reports frames per second.
+// .beast files are read as Beast binary, anything else as AVR. Each piece is
+// parsed at the time of the capture, so the track filter and the even/odd
+// pairing see the same timing as on a live feed.
+//
+// If there is a capture.truth next to the capture, as make_modes.py --truth
+// writes, each aircraft left in the store is checked against it: ICAO, call
+// sign, squawk, altitude, position and velocity, for the groups of fields
+// it was sent since it was last added. Fails on any mismatch.
+//
+//   bench_modes [--iterations N] capture.avr capture.beast...
+
+#include <map>
+#include "ModeSClient.h"
+#include "Bench.h"
+
+// Rounding of the encoders: 25 ft altitude steps, CPR cells of about 5 m,
+// velocity components in whole knots
+#define ALTITUDE_TOLERANCE 13
+#define POSITION_TOLERANCE_METERS 10
+#define SPEED_TOLERANCE 2
+#define TRACK_TOLERANCE_DEGREES 1.0
+
+// Values of an aircraft as make_modes.py generated them, NAN or empty if
+// none of its frames carried them
+struct Truth {
+  char call[AIRCRAFT_CALL_LENGTH + 1];
+  int squawk;
+  double altitude;
+  double lat;
+  double lon;
+  double speed;
+  double track;
+};
+
+static double truthValue(const char* text) {
+  return strcmp(text, "-") == 0 ? NAN : atof(text);
+}
+
+static bool loadTruth(const char* capture, std::map<uint32_t, Truth>& truth) {
+  HostHeapPause pause;
+  String path = String(capture) + ".truth";
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) {
+    return false;
+  }
+  char icao[8], call[AIRCRAFT_CALL_LENGTH + 1], squawk[8], altitude[32], lat[32], lon[32], speed[32], track[32];
+  while (fscanf(f, "%7s %8s %7s %31s %31s %31s %31s %31s", icao, call, squawk, altitude, lat, lon, speed, track) == 8) {
+    Truth& t = truth[strtoul(icao, nullptr, 16)];
+    strcpy(t.call, strcmp(call, "-") == 0 ? "" : call);
+    t.squawk = strcmp(squawk, "-") == 0 ? -1 : atoi(squawk);
+    t.altitude = truthValue(altitude);
+    t.lat = truthValue(lat);
+    t.lon = truthValue(lon);
+    t.speed = truthValue(speed);
+    t.track = truthValue(track);
+  }
+  fclose(f);
+  return true;
+}
+
+// Compares the aircraft in the store with the truth and prints each
+// mismatch. Groups of fields the store has not had since the aircraft was
+// added are skipped, as are a call sign and squawk it has not received.
+// Returns the number of values checked.
+static int checkAircraft(AircraftStore* store, const std::map<uint32_t, Truth>& truth, unsigned long now,
+                         const char* capture, int& mismatches) {
+  int checked = 0;
+  for (int i = 0; i < store->getNumberOfAircrafts(); i++) {
+    AircraftRecord record = store->getRecord(i);
+    auto found = truth.find(record.icao);
+    if (found == truth.end()) {
+      printf("%s: %06X was never sent\n", capture, record.icao);
+      mismatches++;
+      continue;
+    }
+    const Truth& t = found->second;
+    auto reported = [&](uint8_t field) {
+      return now - store->getFieldTime(i, field) < 3600000UL;
+    };
+    auto check = [&](bool ok, const char* what, double got, double expected) {
+      checked++;
+      if (!ok) {
+        printf("%s: %06X %s is %.6f, not %.6f\n", capture, record.icao, what, got, expected);
+        mismatches++;
+      }
+    };
+    if (reported(AIRCRAFT_IDENTITY)) {
+      char call[AIRCRAFT_CALL_LENGTH + 1] = {};
+      memcpy(call, record.call, AIRCRAFT_CALL_LENGTH);
+      if (call[0] != '\0') {
+        checked++;
+        if (strcmp(call, t.call) != 0) {
+          printf("%s: %06X call sign is %s, not %s\n", capture, record.icao, call, t.call);
+          mismatches++;
+        }
+      }
+      if (record.squawk != 0) {
+        // The decoder reads the octal digits as a decimal number
+        check(record.squawk == t.squawk, "squawk", record.squawk, t.squawk);
+      }
+    }
+    if (reported(AIRCRAFT_ALTITUDE)) {
+      check(fabs(record.altitude - t.altitude) <= ALTITUDE_TOLERANCE, "altitude", record.altitude, t.altitude);
+    }
+    if (reported(AIRCRAFT_POSITION)) {
+      double dy = (record.lat / 1e6 - t.lat) * 111195.0;
+      double dx = (record.lon / 1e6 - t.lon) * 111195.0 * cos(t.lat * PI / 180);
+      check(hypot(dx, dy) <= POSITION_TOLERANCE_METERS, "position off by m", hypot(dx, dy), 0);
+    }
+    if (reported(AIRCRAFT_VELOCITY)) {
+      check(fabs(record.speed - t.speed) <= SPEED_TOLERANCE, "speed", record.speed, t.speed);
+      double track = fabs(fmod(record.heading / 10.0 - t.track + 540, 360) - 180);
+      check(track <= TRACK_TOLERANCE_DEGREES, "track off by degrees", track, 0);
+    }
+  }
+  return checked;
+}
+
+struct Piece {
+  size_t offset;
+  size_t length;
+  // Receiver time of the first frame in it, from the start of the capture
+  unsigned long millis;
+};
+
+// Offsets of the frames in the capture and their timestamps in 12 MHz ticks
+static std::vector<std::pair<size_t, uint64_t>> frameStamps(const std::vector<char>& capture, bool beast) {
+  std::vector<std::pair<size_t, uint64_t>> stamps;
+  const uint8_t* data = (const uint8_t*) capture.data();
+  size_t size = capture.size();
+  for (size_t i = 0; i < size; i++) {
+    uint64_t ticks = 0;
+    if (beast && data[i] == 0x1A) {
+      if (i + 1 < size && data[i + 1] == 0x1A) {
+        i++;
+        continue;
+      }
+      // Type, then the timestamp with 0x1A doubled
+      size_t j = i + 2;
+      for (int k = 0; k < 6 && j < size; k++, j++) {
+        ticks = ticks << 8 | data[j];
+        j += data[j] == 0x1A ? 1 : 0;
+      }
+      stamps.push_back({i, ticks});
+    } else if (!beast && data[i] == '@' && i + 13 <= size) {
+      char hex[13];
+      memcpy(hex, &data[i + 1], 12);
+      hex[12] = '\0';
+      stamps.push_back({i, strtoull(hex, nullptr, 16)});
+    }
+  }
+  return stamps;
+}
+
+int main(int argc, char** argv) {
+  int iterations = 5;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+    iterations = atoi(argv[2]);
+    first = 3;
+  }
+  if (first >= argc || iterations <= 0) {
+    fprintf(stderr, "usage: bench_modes [--iterations N] capture.avr capture.beast...\n");
+    return 1;
+  }
+
+  Serial.setOutput(nullptr);
+
+  printf("%-22s %9s %8s %8s %8s %12s %12s %12s %10s %8s\n",
+         "capture", "bytes", "frames", "decoded", "aircraft", "frames/s", "ns/frame", "allocs/frame", "peak heap",
+         "checked");
+  int mismatches = 0;
+  for (int f = first; f < argc; f++) {
+    std::vector<char> capture = benchLoadBody(argv[f]);
+    std::map<uint32_t, Truth> truth;
+    bool hasTruth = loadTruth(argv[f], truth);
+    int checked = 0;
+    size_t nameLength = strlen(argv[f]);
+    bool beast = nameLength > 6 && strcmp(argv[f] + nameLength - 6, ".beast") == 0;
+    std::vector<Piece> pieces;
+    {
+      HostHeapPause pause;
+      std::vector<std::pair<size_t, uint64_t>> stamps = frameStamps(capture, beast);
+      size_t next = 0;
+      unsigned long last = 0;
+      for (size_t i = 0; i < capture.size(); i += FEED_READ_BUFFER_LENGTH) {
+        size_t length = std::min(capture.size() - i, (size_t) FEED_READ_BUFFER_LENGTH);
+        while (next < stamps.size() && stamps[next].first < i) {
+          next++;
+        }
+        if (next < stamps.size() && stamps[next].first < i + length) {
+          last = (stamps[next].second - stamps[0].second) / 12000;
+        }
+        pieces.push_back({i, length, last});
+      }
+    }
+
+    uint64_t elapsed = 0;
+    FeedStats stats = {};
+    int aircraft = 0;
+    for (int i = 0; i <= iterations; i++) {
+      StringPool* strings = new StringPool();
+      AircraftStore* store = new AircraftStore(strings);
+      FeedMerger* merger = new FeedMerger(store);
+      ModeSClient* client = new ModeSClient(merger, "localhost", 30005, beast ? ModeSFormat::Beast : ModeSFormat::Avr);
+      client->setCenter({47.437691, 8.568854});
+      // The first round warms up and is not counted
+      if (i == 1) {
+        hostHeapResetCounters();
+      }
+      uint64_t start = benchNanos();
+      for (const Piece& piece : pieces) {
+        client->parse(&capture[piece.offset], piece.length, piece.millis);
+      }
+      if (i > 0) {
+        elapsed += benchNanos() - start;
+      }
+      stats = client->getStats();
+      aircraft = store->getNumberOfAircrafts();
+      if (i == iterations && hasTruth) {
+        HostHeapPause pause;
+        checked = checkAircraft(store, truth, pieces.empty() ? 0 : pieces.back().millis, benchBaseName(argv[f]),
+                                mismatches);
+      }
+      delete client;
+      delete merger;
+      delete store;
+      delete strings;
+    }
+    HostHeapStats heap = hostHeapStats();
+
+    double frames = (double) stats.frames * iterations;
+    printf("%-22s %9zu %8u %8u %8d %12.0f %12.0f %12.2f %10lld %8s\n",
+           benchBaseName(argv[f]), capture.size(), stats.frames, stats.messages, aircraft,
+           frames / (elapsed / 1e9), elapsed / frames, heap.allocations / frames,
+           (long long) heap.peakLiveBytes, hasTruth ? String(checked).c_str() : "-");
+  }
+  if (mismatches > 0) {
+    fprintf(stderr, "bench_modes: %d decoded values differ from the truth\n", mismatches);
+    return 1;
+  }
+  return 0;
+}
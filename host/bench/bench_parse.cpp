@@ -0,0 +1,132 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Replays recorded AircraftList.json bodies through
+// AdsbExchangeClient::parseRecordedBody(), the path poll() takes once the
+// headers are in, and reports parser throughput. Gzip feeds
+// are inflated on the way, bytes are then those on the wire and MB/s those of
+// the JSON document. Fails if a poll after the first allocates on the heap,
+// parsing is meant to run in the memory the client holds.
+//
+//   bench_parse [--iterations N] feed.json feed.json.gz...
+
+#include "Inflater.h"
+#include "AdsbExchangeClient.h"
+#include "Bench.h"
+
+static bool isGzip(const std::vector<char>& body) {
+  return body.size() >= 2 && (uint8_t) body[0] == 0x1f && (uint8_t) body[1] == 0x8b;
+}
+
+static std::vector<char> inflateBody(const std::vector<char>& body) {
+  HostHeapPause pause;
+  Inflater* inflater = new Inflater();
+  std::vector<char> document;
+  char out[4096];
+  size_t in = 0;
+  while (!inflater->isDone() && !inflater->hasError()) {
+    size_t consumed;
+    size_t produced = inflater->inflate((const uint8_t*) body.data() + in, body.size() - in, consumed, (uint8_t*) out, sizeof(out));
+    in += consumed;
+    document.insert(document.end(), out, out + produced);
+    if (produced == 0 && consumed == 0) {
+      break;
+    }
+  }
+  if (!inflater->isDone()) {
+    fprintf(stderr, "cannot inflate the feed%s\n", inflater->isWindowTooSmall() ? ", window too small" : "");
+    exit(1);
+  }
+  delete inflater;
+  return document;
+}
+
+int main(int argc, char** argv) {
+  int iterations = 20;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+    iterations = atoi(argv[2]);
+    first = 3;
+  }
+  if (first >= argc || iterations <= 0) {
+    fprintf(stderr, "usage: bench_parse [--iterations N] feed.json...\n");
+    return 1;
+  }
+
+  Serial.setOutput(nullptr);
+  int status = 0;
+
+  printf("%-22s %9s %8s %10s %12s %12s %12s %10s %8s\n",
+         "feed", "bytes", "aircraft", "MB/s", "ns/aircraft", "allocs/poll", "bytes/poll", "peak heap", "dropped");
+  for (int f = first; f < argc; f++) {
+    std::vector<char> body = benchLoadBody(argv[f]);
+    std::vector<char> document;
+    {
+      HostHeapPause pause;
+      document = isGzip(body) ? inflateBody(body) : body;
+    }
+    int aircraft = benchCount(document, "\"Id\":");
+    // Fresh store per feed, the aircraft of one feed must not fill it up for the next
+    StringPool* strings = new StringPool();
+    AircraftStore* store = new AircraftStore(strings);
+    FeedMerger* merger = new FeedMerger(store);
+    AdsbExchangeClient* client = new AdsbExchangeClient(merger);
+    HttpEncoding encoding = isGzip(body) ? HttpEncoding::Gzip : HttpEncoding::Identity;
+
+    // Warm up once so the first poll's allocations, the inflater among them,
+    // don't skew the numbers
+    client->parseRecordedBody(body.data(), body.size(), encoding);
+    hostHeapResetCounters();
+
+    uint64_t start = benchNanos();
+    for (int i = 0; i < iterations; i++) {
+      client->parseRecordedBody(body.data(), body.size(), encoding);
+    }
+    uint64_t elapsed = benchNanos() - start;
+    HostHeapStats heap = hostHeapStats();
+
+    double seconds = elapsed / 1e9;
+    printf("%-22s %9zu %8d %10.2f %12.0f %12.0f %12.0f %10lld %8u\n",
+           benchBaseName(argv[f]), body.size(), aircraft,
+           document.size() * (double) iterations / seconds / 1e6,
+           aircraft ? (double) elapsed / iterations / aircraft : 0.0,
+           (double) heap.allocations / iterations,
+           (double) heap.bytesAllocated / iterations,
+           (long long) heap.peakLiveBytes, strings->getNumberOfOverflows());
+    if (heap.allocations > 0) {
+      fprintf(stderr, "%s: %u heap allocations in %d polls\n", benchBaseName(argv[f]), heap.allocations, iterations);
+      status = 1;
+    }
+    if (strings->getNumberOfOverflows() > 0) {
+      fprintf(stderr, "%s: %u texts didn't fit the string pool\n", benchBaseName(argv[f]), strings->getNumberOfOverflows());
+      status = 1;
+    }
+    delete client;
+    delete merger;
+    delete store;
+    delete strings;
+  }
+  return status;
+}
@@ -0,0 +1,129 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Replays SBS-1 captures through SbsClient::parse() in the pieces the socket
+// reads of FeedClient::poll() have, and reports messages per second. Each
+// piece is parsed at the time of the capture, so the track filter sees the
+// same timing as on a live feed.
+//
+//   bench_sbs [--iterations N] capture.sbs...
+
+#include "SbsClient.h"
+#include "Bench.h"
+
+struct Piece {
+  size_t offset;
+  size_t length;
+  // Generation time of the first message in it, from the start of the capture
+  unsigned long millis;
+};
+
+static long stampMillis(const char* line, const char* end) {
+  // Field 8, HH:MM:SS.mmm
+  int commas = 0;
+  while (line < end && commas < 7) {
+    if (*line++ == ',') {
+      commas++;
+    }
+  }
+  if (end - line < 12) {
+    return -1;
+  }
+  return ((atol(line) * 60 + atol(line + 3)) * 60 + atol(line + 6)) * 1000 + atol(line + 9);
+}
+
+int main(int argc, char** argv) {
+  int iterations = 5;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+    iterations = atoi(argv[2]);
+    first = 3;
+  }
+  if (first >= argc || iterations <= 0) {
+    fprintf(stderr, "usage: bench_sbs [--iterations N] capture.sbs...\n");
+    return 1;
+  }
+
+  Serial.setOutput(nullptr);
+
+  printf("%-22s %9s %8s %8s %12s %12s %12s %10s\n",
+         "capture", "bytes", "lines", "aircraft", "msgs/s", "ns/msg", "allocs/msg", "peak heap");
+  for (int f = first; f < argc; f++) {
+    std::vector<char> capture = benchLoadBody(argv[f]);
+    std::vector<Piece> pieces;
+    {
+      HostHeapPause pause;
+      long start = -1;
+      long last = 0;
+      for (size_t i = 0; i < capture.size(); i += FEED_READ_BUFFER_LENGTH) {
+        size_t length = std::min(capture.size() - i, (size_t) FEED_READ_BUFFER_LENGTH);
+        // The first whole line in the piece
+        const char* line = (const char*) memchr(&capture[i], '\n', length);
+        long stamp = line ? stampMillis(line + 1, &capture[i] + length) : -1;
+        if (stamp >= 0) {
+          start = start < 0 ? stamp : start;
+          last = stamp - start;
+        }
+        pieces.push_back({i, length, (unsigned long) last});
+      }
+    }
+
+    uint64_t elapsed = 0;
+    uint32_t lines = 0;
+    int aircraft = 0;
+    for (int i = 0; i <= iterations; i++) {
+      StringPool* strings = new StringPool();
+      AircraftStore* store = new AircraftStore(strings);
+      FeedMerger* merger = new FeedMerger(store);
+      SbsClient* client = new SbsClient(merger, "localhost", 30003);
+      client->setCenter({47.437691, 8.568854});
+      // The first round warms up and is not counted
+      if (i == 1) {
+        hostHeapResetCounters();
+      }
+      uint64_t start = benchNanos();
+      for (const Piece& piece : pieces) {
+        client->parse(&capture[piece.offset], piece.length, piece.millis);
+      }
+      if (i > 0) {
+        elapsed += benchNanos() - start;
+      }
+      lines = client->getStats().frames;
+      aircraft = store->getNumberOfAircrafts();
+      delete client;
+      delete merger;
+      delete store;
+      delete strings;
+    }
+    HostHeapStats heap = hostHeapStats();
+
+    double messages = (double) lines * iterations;
+    printf("%-22s %9zu %8u %8d %12.0f %12.0f %12.2f %10lld\n",
+           benchBaseName(argv[f]), capture.size(), lines, aircraft,
+           messages / (elapsed / 1e9), elapsed / messages, heap.allocations / messages,
+           (long long) heap.peakLiveBytes);
+  }
+  return 0;
+}
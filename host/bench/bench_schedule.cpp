@@ -0,0 +1,262 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+// Flies a day of simulated traffic over the map and polls it the way the
+// sketch polls ADS-B Exchange, once every 2 s and with PollScheduler. Each
+// poll goes through FeedMerger into the store; every FRAME_INTERVAL_MILLIS
+// each aircraft is drawn where AircraftStore::getAircraft() extrapolates it
+// and compared with where it really is. Reports requests, how far the shown positions
+// are off in pixels, and for how long aircraft on the map weren't shown yet.
+//
+// Traffic follows the hour of the day, from a few aircraft at night to
+// about 40 at the peaks. Aircraft fly straight legs and standard rate turns.
+// The server fails 1 % of the polls and is down from 13:00 to 13:20.
+//
+//   bench_schedule [--zoom N] [--seed N]
+
+#include "settings.h"
+#include "PollScheduler.h"
+#include "Bench.h"
+
+#define DAY_SECONDS 86400
+#define CENTER_LAT 47.437691
+#define CENTER_LON 8.568854
+#define OUTAGE_START (13 * 3600)
+#define OUTAGE_END (OUTAGE_START + 1200)
+// Pixel error histogram, quarter pixels
+#define ERROR_BUCKETS 400
+
+// Aircraft entering the map per hour, by hour of the day
+static const int ARRIVALS[24] = {2, 1, 1, 1, 2, 8, 30, 45, 45, 40, 35, 35,
+                                 40, 40, 35, 35, 40, 45, 45, 40, 30, 20, 10, 4};
+
+struct Flight {
+  uint32_t icao;
+  // Meters east and north of the center, meters per second, radians
+  double x;
+  double y;
+  double speed;
+  double heading;
+  // Radians per second, 0 on a straight leg, and when the leg ends
+  double turnRate;
+  double legEnd;
+};
+
+struct Result {
+  uint32_t requests;
+  uint32_t failures;
+  double meanInterval;
+  uint64_t samples;
+  double errorSum;
+  uint32_t errors[ERROR_BUCKETS];
+  // Frames an aircraft on the map was not shown in
+  uint32_t missing;
+  uint32_t inView;
+};
+
+static double uniform(double low, double high) {
+  return low + (high - low) * (rand() / (RAND_MAX + 1.0));
+}
+
+static void startLeg(Flight& flight, double seconds) {
+  if (uniform(0, 1) < 0.6) {
+    flight.turnRate = 0;
+    flight.legEnd = seconds + uniform(30, 240);
+  } else {
+    // Standard rate or half of it, for 10 to 60 degrees
+    flight.turnRate = (uniform(0, 1) < 0.5 ? 0.0524 : 0.0262) * (uniform(0, 1) < 0.5 ? -1 : 1);
+    flight.legEnd = seconds + uniform(10, 60) * 0.0175 / fabs(flight.turnRate);
+  }
+}
+
+static AircraftRecord toRecord(const Flight& flight, uint16_t distance) {
+  AircraftRecord record = {};
+  record.icao = flight.icao;
+  record.lat = lround((CENTER_LAT + flight.y / 111195.0) * 1e6);
+  record.lon = lround((CENTER_LON + flight.x / (111195.0 * cos(CENTER_LAT * PI / 180))) * 1e6);
+  record.speed = flight.speed / 0.5144 + 0.5;
+  double degrees = fmod(flight.heading * 180 / PI + 360, 360);
+  record.heading = (uint16_t) (degrees * 10 + 0.5) % 3600;
+  record.distance = distance;
+  record.altitude = 10000;
+  return record;
+}
+
+static Result fly(bool adaptive, double metersPerPixel, double halfWidth, double halfHeight, unsigned seed) {
+  srand(seed);
+  StringPool* strings = new StringPool();
+  AircraftStore* store = new AircraftStore(strings);
+  FeedMerger* merger = new FeedMerger(store);
+  uint8_t source = merger->addSource("ADSBx");
+  PollScheduler* scheduler = new PollScheduler(merger, source);
+  scheduler->setMetersPerPixel(metersPerPixel);
+
+  Result result = {};
+  std::vector<Flight> flights;
+  uint32_t nextIcao = 0x400000;
+  // Sim time in ms, starting away from 0 like millis() after boot
+  const unsigned long base = 60000;
+  unsigned long nextPoll = base;
+  boolean polling = false;
+  boolean success = false;
+  unsigned long pollStart = 0;
+  unsigned long answered = 0;
+  std::vector<AircraftRecord> answer;
+  const double step = FRAME_INTERVAL_MILLIS / 1000.0;
+  for (unsigned long frame = 0; frame < DAY_SECONDS * 1000UL / FRAME_INTERVAL_MILLIS; frame++) {
+    unsigned long now = base + frame * FRAME_INTERVAL_MILLIS;
+    double seconds = frame * step;
+    if (uniform(0, 3600) < ARRIVALS[(int) seconds / 3600] * step) {
+      // Enters at the edge, heading roughly across the map
+      Flight flight = {};
+      flight.icao = nextIcao++;
+      double angle = uniform(0, 2 * PI);
+      flight.x = cos(angle) * halfWidth * 1.2;
+      flight.y = sin(angle) * halfHeight * 1.2;
+      flight.heading = PI / 2 - angle + PI + uniform(-0.6, 0.6);
+      flight.speed = uniform(70, 250);
+      startLeg(flight, seconds);
+      flights.push_back(flight);
+    }
+
+    // The server answers with where the aircraft are at the start of the
+    // poll; the answer takes 200 ms plus 3 ms per aircraft and goes into the
+    // store when it is in
+    if (!polling && now >= nextPoll) {
+      polling = true;
+      result.requests++;
+      boolean outage = seconds >= OUTAGE_START && seconds < OUTAGE_END;
+      success = !outage && uniform(0, 1) >= 0.01;
+      pollStart = now;
+      answered = now + 200 + 3 * flights.size();
+      answer.clear();
+      for (const Flight& flight : flights) {
+        if (fabs(flight.x) <= halfWidth * 1.3 && fabs(flight.y) <= halfHeight * 1.3) {
+          answer.push_back(toRecord(flight, hypot(flight.x, flight.y) / 10));
+        }
+      }
+    }
+    if (polling && now >= answered) {
+      polling = false;
+      if (success) {
+        for (AircraftRecord& record : answer) {
+          merger->update(record, nullptr, AIRCRAFT_ALL_FIELDS, source, pollStart, now);
+        }
+        merger->removeStale(now);
+      } else {
+        result.failures++;
+      }
+      if (adaptive) {
+        scheduler->pollFinished(success, now - pollStart, now);
+        nextPoll = now + scheduler->getInterval();
+      } else {
+        nextPoll = now + 2000;
+      }
+    }
+
+    // Draw, then move on by a frame
+    for (size_t f = 0; f < flights.size(); f++) {
+      Flight& flight = flights[f];
+      if (fabs(flight.x) <= halfWidth && fabs(flight.y) <= halfHeight && !(seconds >= OUTAGE_START && seconds < OUTAGE_END + 300)) {
+        result.inView++;
+        int i = store->find(flight.icao);
+        if (i < 0) {
+          result.missing++;
+        } else {
+          Aircraft shown = store->getAircraft(i, now);
+          double dx = (shown.lon - CENTER_LON) * 111195.0 * cos(CENTER_LAT * PI / 180) - flight.x;
+          double dy = (shown.lat - CENTER_LAT) * 111195.0 - flight.y;
+          double pixels = hypot(dx, dy) / metersPerPixel;
+          int bucket = pixels * 4;
+          result.errors[bucket < ERROR_BUCKETS ? bucket : ERROR_BUCKETS - 1]++;
+          result.errorSum += pixels;
+          result.samples++;
+        }
+      }
+      flight.heading += flight.turnRate * step;
+      flight.x += flight.speed * step * sin(flight.heading);
+      flight.y += flight.speed * step * cos(flight.heading);
+      if (seconds >= flight.legEnd) {
+        startLeg(flight, seconds);
+      }
+      if (fabs(flight.x) > halfWidth * 1.5 || fabs(flight.y) > halfHeight * 1.5) {
+        flights[f--] = flights.back();
+        flights.pop_back();
+      }
+    }
+  }
+  PollStats stats = scheduler->getStats();
+  result.meanInterval = adaptive && stats.polls ? (double) stats.intervalSum / stats.polls : 2000;
+  delete scheduler;
+  delete merger;
+  delete store;
+  delete strings;
+  return result;
+}
+
+static double percentile(const Result& result, double share) {
+  uint64_t wanted = result.samples * share;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < ERROR_BUCKETS; bucket++) {
+    seen += result.errors[bucket];
+    if (seen > wanted) {
+      return (bucket + 1) / 4.0;
+    }
+  }
+  return ERROR_BUCKETS / 4.0;
+}
+
+int main(int argc, char** argv) {
+  int zoom = MAP_ZOOM;
+  unsigned seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--zoom") == 0 && i + 1 < argc) {
+      zoom = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: bench_schedule [--zoom N] [--seed N]\n");
+      return 1;
+    }
+  }
+  Serial.setOutput(nullptr);
+
+  // As GeoMap::getMetersPerPixel()
+  double metersPerPixel = 40075016.7 * cos(CENTER_LAT * PI / 180) / (256 * pow(2.0, zoom));
+  double halfWidth = MAP_WIDTH / 2.0 * metersPerPixel;
+  double halfHeight = MAP_HEIGHT / 2.0 * metersPerPixel;
+
+  printf("zoom %d, %.0f m per pixel\n", zoom, metersPerPixel);
+  printf("%-10s %9s %8s %12s %10s %10s %10s %10s\n",
+         "schedule", "requests", "failed", "interval ms", "mean px", "p95 px", "p99 px", "unseen %");
+  for (int adaptive = 0; adaptive <= 1; adaptive++) {
+    Result result = fly(adaptive, metersPerPixel, halfWidth, halfHeight, seed);
+    printf("%-10s %9u %8u %12.0f %10.2f %10.2f %10.2f %10.2f\n", adaptive ? "adaptive" : "fixed 2s",
+           result.requests, result.failures, result.meanInterval, result.errorSum / result.samples,
+           percentile(result, 0.95), percentile(result, 0.99), 100.0 * result.missing / result.inView);
+  }
+  return 0;
+}
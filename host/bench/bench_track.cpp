@@ -0,0 +1,182 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at http://blog.squix.ch
+*/
+
+
+// Feeds noisy fixes of straight tracks through AircraftStore every 2 s, as
+// polls of ADS-B Exchange would, and compares the filtered position with the
+// truth. Then checks that a single far off fix is rejected and that an
+// aircraft that really jumps is followed again. Fails if the filter doesn't
+// beat the raw fixes or the outlier handling is off.
+//
+//   bench_track [--noise MICRO_DEGREES] [--seed N]
+
+#include "AircraftStore.h"
+#include "Bench.h"
+
+#define TRACKS 200
+#define FIXES 60
+#define FIX_MILLIS 2000
+#define OUTLIER_OFFSET 50000
+// The jump has to be followed once the track is older than this
+#define JUMP_MILLIS (MAX_EXTRAPOLATION_MILLIS + 2 * FIX_MILLIS)
+
+struct Track {
+  // Micro degrees at time 0, micro degrees of latitude per second
+  double lat;
+  double lon;
+  double latSpeed;
+  double lonSpeed;
+  uint16_t knots;
+  uint16_t heading;
+};
+
+static double uniform(double low, double high) {
+  return low + (high - low) * (rand() / (RAND_MAX + 1.0));
+}
+
+static double gaussian() {
+  return sqrt(-2 * log(uniform(1e-12, 1))) * cos(2 * PI * uniform(0, 1));
+}
+
+static Track randomTrack() {
+  Track track;
+  track.lat = uniform(46e6, 48e6);
+  track.lon = uniform(7e6, 10e6);
+  track.knots = uniform(120, 480);
+  track.heading = uniform(0, 3600);
+  double speed = track.knots * (1e6 / 3600 / 60);
+  double heading = track.heading * PI / 1800;
+  track.latSpeed = speed * cos(heading);
+  track.lonSpeed = speed * sin(heading) / cos(track.lat * PI / 180e6);
+  return track;
+}
+
+static AircraftRecord fix(const Track& track, unsigned long millis, double latError, double lonError) {
+  AircraftRecord record = {};
+  record.icao = 0x400000;
+  record.lat = lround(track.lat + track.latSpeed * millis / 1000 + latError);
+  record.lon = lround(track.lon + track.lonSpeed * millis / 1000 + lonError);
+  record.speed = track.knots;
+  record.heading = track.heading;
+  record.altitude = 10000;
+  return record;
+}
+
+// Distance in micro degrees of latitude
+static double error(const Track& track, unsigned long millis, double lat, double lon) {
+  double dLat = lat - (track.lat + track.latSpeed * millis / 1000);
+  double dLon = (lon - (track.lon + track.lonSpeed * millis / 1000)) * cos(track.lat * PI / 180e6);
+  return hypot(dLat, dLon);
+}
+
+int main(int argc, char** argv) {
+  double noise = 150;
+  unsigned seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+      noise = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: bench_track [--noise MICRO_DEGREES] [--seed N]\n");
+      return 1;
+    }
+  }
+  Serial.setOutput(nullptr);
+  srand(seed);
+  StringPool* strings = new StringPool();
+  AircraftStore* store = new AircraftStore(strings);
+  const unsigned long base = 60000;
+
+  // Straight tracks, the first fix of each only starts the filter
+  double rawSquares = 0;
+  double filteredSquares = 0;
+  int samples = 0;
+  uint64_t nanos = 0;
+  for (int t = 0; t < TRACKS; t++) {
+    Track track = randomTrack();
+    for (int f = 0; f < FIXES; f++) {
+      unsigned long millis = f * FIX_MILLIS;
+      AircraftRecord record = fix(track, millis, noise * gaussian(), noise * gaussian());
+      uint64_t start = benchNanos();
+      int i = store->update(record, nullptr, base + millis, AIRCRAFT_ALL_FIELDS, 0, base + millis);
+      nanos += benchNanos() - start;
+      if (f > 0) {
+        Aircraft shown = store->getAircraft(i);
+        double raw = error(track, millis, record.lat, record.lon);
+        double filtered = error(track, millis, shown.lat * 1e6, shown.lon * 1e6);
+        rawSquares += raw * raw;
+        filteredSquares += filtered * filtered;
+        samples++;
+      }
+    }
+    store->removeStale(base + (FIXES + 60) * FIX_MILLIS);
+  }
+  double rawRms = sqrt(rawSquares / samples);
+  double filteredRms = sqrt(filteredSquares / samples);
+
+  // One fix OUTLIER_OFFSET off in the middle of a track, then the same
+  // track again with the aircraft staying there
+  Track track = randomTrack();
+  unsigned long now = base + 10 * 86400000UL;
+  boolean outlierRejected = true;
+  long jumpFollowed = -1;
+  for (int pass = 0; pass < 2; pass++) {
+    for (int f = 0; f < FIXES; f++) {
+      unsigned long millis = f * FIX_MILLIS;
+      double offset = (pass == 0 ? f == FIXES / 2 : f >= FIXES / 2) ? OUTLIER_OFFSET : 0;
+      AircraftRecord record = fix(track, millis, noise * gaussian() + offset, noise * gaussian());
+      int i = store->update(record, nullptr, now + millis, AIRCRAFT_ALL_FIELDS, 0, now + millis);
+      boolean accepted = store->getRecord(i).lat == record.lat;
+      if (pass == 0 && offset != 0 && accepted) {
+        outlierRejected = false;
+      }
+      if (pass == 1 && offset != 0 && accepted && jumpFollowed < 0) {
+        jumpFollowed = (f - FIXES / 2) * FIX_MILLIS;
+      }
+    }
+    now += (FIXES + 60) * FIX_MILLIS;
+    store->removeStale(now);
+  }
+
+  printf("%-10s %8s %10s %12s %12s %10s %14s\n",
+         "noise", "fixes", "raw rms", "filtered rms", "ns/update", "outlier", "jump followed");
+  char followed[32];
+  if (jumpFollowed < 0) {
+    strcpy(followed, "never");
+  } else {
+    snprintf(followed, sizeof(followed), "after %ld ms", jumpFollowed);
+  }
+  printf("%-10.0f %8d %10.1f %12.1f %12.1f %10s %14s\n", noise, samples, rawRms, filteredRms,
+         (double) nanos / (TRACKS * FIXES), outlierRejected ? "rejected" : "accepted", followed);
+
+  delete store;
+  delete strings;
+  if (filteredRms >= rawRms || !outlierRejected || jumpFollowed < 0 || jumpFollowed > JUMP_MILLIS) {
+    fprintf(stderr, "bench_track: the track filter regressed\n");
+    return 1;
+  }
+  return 0;
+}
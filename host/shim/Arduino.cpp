@@ -0,0 +1,176 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "Arduino.h"
+#include "HostHeap.h"
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static unsigned long long nowMicros() {
+  static struct timespec start = {0, 0};
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (start.tv_sec == 0 && start.tv_nsec == 0) {
+    start = now;
+  }
+  return (unsigned long long) (now.tv_sec - start.tv_sec) * 1000000ULL + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+unsigned long millis() {
+  return nowMicros() / 1000;
+}
+
+unsigned long micros() {
+  return nowMicros();
+}
+
+void delay(unsigned long ms) {
+  usleep(ms * 1000);
+}
+
+void yield() {
+}
+
+long random(long howbig) {
+  return howbig > 0 ? rand() % howbig : 0;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  int64_t live = hostHeapStats().liveBytes;
+  return live < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - live : 0;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char *str) {
+  return write((const uint8_t *) str, strlen(str));
+}
+
+size_t Print::print(const String &s) {
+  return write((const uint8_t *) s.c_str(), s.length());
+}
+
+size_t Print::print(const char *s) {
+  return write(s);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t) c);
+}
+
+size_t Print::print(int n, int base) {
+  return print(String((long) n, base));
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print(String((unsigned long) n, base));
+}
+
+size_t Print::print(long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(double n, int digits) {
+  return print(String(n, digits));
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const String &s) {
+  return print(s) + println();
+}
+
+size_t Print::println(const char *s) {
+  return print(s) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits) {
+  return print(n, digits) + println();
+}
+
+size_t Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  return write((const uint8_t *) buf, len < (int) sizeof(buf) ? len : sizeof(buf) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  if (!out_) {
+    return size;
+  }
+  // Serial.println() sends \r\n like the ESP does; drop the \r on a terminal
+  for (size_t i = 0; i < size; i++) {
+    if (buffer[i] != '\r') {
+      fputc(buffer[i], out_);
+    }
+  }
+  return size;
+}
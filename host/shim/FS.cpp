@@ -0,0 +1,106 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "FS.h"
+#include "HostHeap.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::FS SPIFFS;
+
+namespace fs {
+
+int File::read() {
+  if (!f_) {
+    return -1;
+  }
+  int c = fgetc(f_);
+  return c == EOF ? -1 : c;
+}
+
+int File::available() {
+  if (!f_) {
+    return 0;
+  }
+  long pos = ftell(f_);
+  return size() - pos;
+}
+
+size_t File::size() {
+  if (!f_) {
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fileno(f_), &st) != 0) {
+    return 0;
+  }
+  return st.st_size;
+}
+
+void File::close() {
+  if (f_) {
+    fclose(f_);
+    f_ = nullptr;
+  }
+}
+
+String FS::hostPath(const String& path) {
+  HostHeapPause pause;
+  const char* root = getenv("SPIFFS_ROOT");
+  return String(root ? root : "spiffs") + path;
+}
+
+bool FS::begin() {
+  HostHeapPause pause;
+  String root = hostPath("");
+  mkdir(root.c_str(), 0755);
+  return access(root.c_str(), W_OK) == 0;
+}
+
+bool FS::exists(const String& path) {
+  HostHeapPause pause;
+  return access(hostPath(path).c_str(), F_OK) == 0;
+}
+
+File FS::open(const String& path, const char* mode) {
+  HostHeapPause pause;
+  String fopenMode = mode;
+  if (fopenMode.indexOf('b') < 0) {
+    fopenMode += "b";
+  }
+  return File(fopen(hostPath(path).c_str(), fopenMode.c_str()));
+}
+
+bool FS::remove(const String& path) {
+  HostHeapPause pause;
+  return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const String& pathFrom, const String& pathTo) {
+  HostHeapPause pause;
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+}
@@ -0,0 +1,70 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// SPIFFS for the host build, backed by a directory on disk. The directory is
+// $SPIFFS_ROOT or ./spiffs.
+#pragma once
+
+#include "Arduino.h"
+
+namespace fs {
+
+class File {
+  private:
+    FILE* f_ = nullptr;
+
+  public:
+    File() {}
+    explicit File(FILE* f) : f_(f) {}
+
+    size_t write(uint8_t c) { return f_ ? fwrite(&c, 1, 1, f_) : 0; }
+    size_t write(const uint8_t *buf, size_t size) { return f_ ? fwrite(buf, 1, size, f_) : 0; }
+    int read();
+    size_t read(uint8_t* buf, size_t size) { return f_ ? fread(buf, 1, size, f_) : 0; }
+    int available();
+    size_t size();
+    bool seek(uint32_t pos) { return f_ && fseek(f_, pos, SEEK_SET) == 0; }
+    void close();
+    operator bool() const { return f_ != nullptr; }
+};
+
+class FS {
+  public:
+    bool begin();
+    bool exists(const String& path);
+    File open(const String& path, const char* mode);
+    bool remove(const String& path);
+    bool rename(const String& pathFrom, const String& pathTo);
+    String hostPath(const String& path);
+};
+
+}
+
+extern fs::FS SPIFFS;
+
+#ifndef FS_NO_GLOBALS
+using fs::FS;
+using fs::File;
+#endif
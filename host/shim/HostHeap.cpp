@@ -0,0 +1,146 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "HostHeap.h"
+#include <stdlib.h>
+#include <new>
+
+// Every block carries its size and whether it was counted in front, so
+// realloc/free can keep liveBytes exact. 16 bytes keeps the payload aligned
+// like malloc would.
+#define HEADER_SIZE 16
+
+struct BlockHeader {
+  size_t size;
+  bool counted;
+};
+
+static HostHeapStats stats = {};
+static int pauseDepth = 0;
+
+static void account(int64_t delta) {
+  stats.liveBytes += delta;
+  if (stats.liveBytes > stats.peakLiveBytes) {
+    stats.peakLiveBytes = stats.liveBytes;
+  }
+}
+
+void* hostMalloc(size_t size) {
+  char* block = (char*) malloc(size + HEADER_SIZE);
+  if (!block) {
+    return nullptr;
+  }
+  BlockHeader* header = (BlockHeader*) block;
+  header->size = size;
+  header->counted = pauseDepth == 0;
+  if (header->counted) {
+    stats.allocations++;
+    stats.bytesAllocated += size;
+    account(size);
+  }
+  return block + HEADER_SIZE;
+}
+
+void* hostRealloc(void* ptr, size_t size) {
+  if (!ptr) {
+    return hostMalloc(size);
+  }
+  char* block = (char*) ptr - HEADER_SIZE;
+  size_t oldSize = ((BlockHeader*) block)->size;
+  block = (char*) realloc(block, size + HEADER_SIZE);
+  if (!block) {
+    return nullptr;
+  }
+  BlockHeader* header = (BlockHeader*) block;
+  header->size = size;
+  if (header->counted) {
+    // A realloc is a fresh allocation as far as fragmentation is concerned
+    stats.allocations++;
+    stats.frees++;
+    stats.bytesAllocated += size;
+    account((int64_t) size - (int64_t) oldSize);
+  }
+  return block + HEADER_SIZE;
+}
+
+void hostFree(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  char* block = (char*) ptr - HEADER_SIZE;
+  BlockHeader* header = (BlockHeader*) block;
+  if (header->counted) {
+    stats.frees++;
+    account(-(int64_t) header->size);
+  }
+  free(block);
+}
+
+HostHeapStats hostHeapStats() {
+  return stats;
+}
+
+void hostHeapResetCounters() {
+  stats.allocations = 0;
+  stats.frees = 0;
+  stats.bytesAllocated = 0;
+  stats.peakLiveBytes = stats.liveBytes;
+}
+
+HostHeapPause::HostHeapPause() {
+  pauseDepth++;
+}
+
+HostHeapPause::~HostHeapPause() {
+  pauseDepth--;
+}
+
+void* operator new(size_t size) {
+  void* ptr = hostMalloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  hostFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  hostFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  hostFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  hostFree(ptr);
+}
@@ -0,0 +1,57 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Counting allocator for the host build. String and the global operator new
+// both go through it, so the numbers match what the ESP8266 heap would see.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Heap size of a freshly booted sketch, used for ESP.getFreeHeap()
+#define HOST_HEAP_SIZE 40960
+
+struct HostHeapStats {
+  uint32_t allocations;
+  uint32_t frees;
+  uint64_t bytesAllocated;
+  int64_t liveBytes;
+  int64_t peakLiveBytes;
+};
+
+void* hostMalloc(size_t size);
+void* hostRealloc(void* ptr, size_t size);
+void hostFree(void* ptr);
+
+HostHeapStats hostHeapStats();
+void hostHeapResetCounters();
+
+// Allocations made while a HostHeapPause is alive are not counted. The shim
+// uses it for its own bookkeeping so only sketch code shows up in the stats.
+class HostHeapPause {
+  public:
+    HostHeapPause();
+    ~HostHeapPause();
+};
@@ -0,0 +1,98 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#define FS_NO_GLOBALS
+#include "JPEGDecoder.h"
+#include "FS.h"
+#include "HostHeap.h"
+
+#define MAP_GREY 0xD69A
+
+JPEGDecoder JpegDec;
+
+int JPEGDecoder::decodeHeader(const uint8_t* data, uint32_t length) {
+  width = height = 0;
+  // Baseline (C0) or progressive (C2) start of frame: FF Cx len(2) p(1) h(2) w(2)
+  for (uint32_t i = 0; i + 8 < length; i++) {
+    if (data[i] == 0xFF && (data[i + 1] == 0xC0 || data[i + 1] == 0xC2)) {
+      height = (data[i + 5] << 8) | data[i + 6];
+      width = (data[i + 7] << 8) | data[i + 8];
+      break;
+    }
+  }
+  if (width == 0 || height == 0) {
+    totalMcus_ = 0;
+    return 0;
+  }
+  MCUSPerRow = (width + MCUWidth - 1) / MCUWidth;
+  MCUSPerCol = (height + MCUHeight - 1) / MCUHeight;
+  totalMcus_ = MCUSPerRow * MCUSPerCol;
+  nextMcu_ = 0;
+  return 1;
+}
+
+int JPEGDecoder::decodeFile(const String& filename) {
+  HostHeapPause pause;
+  fs::File f = SPIFFS.open(filename, "r");
+  if (!f) {
+    totalMcus_ = 0;
+    return 0;
+  }
+  std::vector<uint8_t> data(f.size());
+  f.read(data.data(), data.size());
+  f.close();
+  return decodeHeader(data.data(), data.size());
+}
+
+int JPEGDecoder::decodeArray(const uint8_t array[], uint32_t array_size) {
+  return decodeHeader(array, array_size);
+}
+
+int JPEGDecoder::read() {
+  if (nextMcu_ >= totalMcus_) {
+    return 0;
+  }
+  MCUx = nextMcu_ % MCUSPerRow;
+  MCUy = nextMcu_ / MCUSPerRow;
+  for (int i = 0; i < MCUWidth * MCUHeight; i++) {
+    mcu_[i] = MAP_GREY;
+  }
+  nextMcu_++;
+  return 1;
+}
+
+int JPEGDecoder::readSwappedBytes() {
+  if (!read()) {
+    return 0;
+  }
+  for (int i = 0; i < MCUWidth * MCUHeight; i++) {
+    mcu_[i] = (mcu_[i] >> 8) | (mcu_[i] << 8);
+  }
+  return 1;
+}
+
+void JPEGDecoder::abort() {
+  nextMcu_ = totalMcus_;
+}
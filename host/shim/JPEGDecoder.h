@@ -0,0 +1,62 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// JPEGDecoder for the host build. There is no real decoder on the host: the
+// image size is read from the JPEG frame header and the MCUs are filled with
+// a flat colour, so PlaneSpotter::renderJPEG() and the TFT window path run
+// with the same geometry as on the device.
+#pragma once
+
+#include "Arduino.h"
+
+class JPEGDecoder {
+  private:
+    uint16_t mcu_[16 * 16];
+    int32_t nextMcu_ = 0;
+    int32_t totalMcus_ = 0;
+
+    int decodeHeader(const uint8_t* data, uint32_t length);
+
+  public:
+    uint16_t *pImage = mcu_;
+    int width = 0;
+    int height = 0;
+    int comps = 3;
+    int MCUSPerRow = 0;
+    int MCUSPerCol = 0;
+    int scanType = 0;
+    int MCUWidth = 16;
+    int MCUHeight = 16;
+    int MCUx = 0;
+    int MCUy = 0;
+
+    int decodeFile(const String& filename);
+    int decodeArray(const uint8_t array[], uint32_t array_size);
+    int read();
+    int readSwappedBytes();
+    void abort();
+};
+
+extern JPEGDecoder JpegDec;
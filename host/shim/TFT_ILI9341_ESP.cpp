@@ -0,0 +1,205 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "TFT_ILI9341_ESP.h"
+
+#define CHAR_WIDTH 6
+#define CHAR_HEIGHT 8
+
+TFT_ILI9341_ESP::TFT_ILI9341_ESP(int16_t w, int16_t h) {
+  width_ = w;
+  height_ = h;
+  memset(frame_, 0, sizeof(frame_));
+}
+
+void TFT_ILI9341_ESP::setRotation(uint8_t r) {
+  if (r & 1) {
+    width_ = TFT_HEIGHT;
+    height_ = TFT_WIDTH;
+  } else {
+    width_ = TFT_WIDTH;
+    height_ = TFT_HEIGHT;
+  }
+}
+
+void TFT_ILI9341_ESP::pixel(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return;
+  }
+  frame_[y * width_ + x] = color;
+  stats_.pixelsWritten++;
+}
+
+void TFT_ILI9341_ESP::fillScreen(uint16_t color) {
+  fillRect(0, 0, width_, height_, color);
+}
+
+void TFT_ILI9341_ESP::drawPixel(int32_t x, int32_t y, uint16_t color) {
+  stats_.drawCalls++;
+  pixel(x, y, color);
+}
+
+void TFT_ILI9341_ESP::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) {
+  stats_.drawCalls++;
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  while (true) {
+    pixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void TFT_ILI9341_ESP::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  drawLine(x, y, x + w - 1, y, color);
+  drawLine(x, y + h - 1, x + w - 1, y + h - 1, color);
+  drawLine(x, y, x, y + h - 1, color);
+  drawLine(x + w - 1, y, x + w - 1, y + h - 1, color);
+}
+
+void TFT_ILI9341_ESP::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  stats_.drawCalls++;
+  for (int32_t j = y; j < y + h; j++) {
+    for (int32_t i = x; i < x + w; i++) {
+      pixel(i, j, color);
+    }
+  }
+}
+
+void TFT_ILI9341_ESP::fillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color) {
+  stats_.drawCalls++;
+  for (int32_t y = -r; y <= r; y++) {
+    for (int32_t x = -r; x <= r; x++) {
+      if (x * x + y * y <= r * r) {
+        pixel(x0 + x, y0 + y, color);
+      }
+    }
+  }
+}
+
+void TFT_ILI9341_ESP::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color) {
+  stats_.drawCalls++;
+  int32_t minX = std::min(x0, std::min(x1, x2)), maxX = std::max(x0, std::max(x1, x2));
+  int32_t minY = std::min(y0, std::min(y1, y2)), maxY = std::max(y0, std::max(y1, y2));
+  for (int32_t y = minY; y <= maxY; y++) {
+    for (int32_t x = minX; x <= maxX; x++) {
+      int32_t w0 = (x1 - x0) * (y - y0) - (y1 - y0) * (x - x0);
+      int32_t w1 = (x2 - x1) * (y - y1) - (y2 - y1) * (x - x1);
+      int32_t w2 = (x0 - x2) * (y - y2) - (y0 - y2) * (x - x2);
+      if ((w0 >= 0 && w1 >= 0 && w2 >= 0) || (w0 <= 0 && w1 <= 0 && w2 <= 0)) {
+        pixel(x, y, color);
+      }
+    }
+  }
+}
+
+void TFT_ILI9341_ESP::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  stats_.drawCalls++;
+  winX0_ = winX_ = x0;
+  winY0_ = winY_ = y0;
+  winX1_ = x1;
+  winY1_ = y1;
+}
+
+void TFT_ILI9341_ESP::pushColor(uint16_t color) {
+  pixel(winX_, winY_, color);
+  if (++winX_ > winX1_) {
+    winX_ = winX0_;
+    winY_++;
+  }
+}
+
+void TFT_ILI9341_ESP::pushColors(uint8_t *data, uint32_t len) {
+  // len is in bytes, pixels arrive byte swapped like on the SPI bus
+  for (uint32_t i = 0; i + 1 < len; i += 2) {
+    pushColor((data[i] << 8) | data[i + 1]);
+  }
+}
+
+int16_t TFT_ILI9341_ESP::textWidth(const char* string, int font) {
+  return strlen(string) * CHAR_WIDTH;
+}
+
+int16_t TFT_ILI9341_ESP::drawString(const char* string, int32_t x, int32_t y, int font) {
+  int16_t width = textWidth(string, font);
+  int16_t boxWidth = width > textPadding_ ? width : textPadding_;
+  int32_t left = x;
+  int32_t top = y;
+  switch (textDatum_ % 3) {
+    case 1: left -= boxWidth / 2; break;
+    case 2: left -= boxWidth; break;
+  }
+  switch (textDatum_ / 3) {
+    case 1: top -= CHAR_HEIGHT / 2; break;
+    case 2: top -= CHAR_HEIGHT; break;
+  }
+  if (textBgColor_ != textColor_) {
+    fillRect(left, top, boxWidth, CHAR_HEIGHT, textBgColor_);
+  }
+  // Stand-in for glyphs: one underline in the text colour
+  drawLine(left, top + CHAR_HEIGHT - 1, left + width - 1, top + CHAR_HEIGHT - 1, textColor_);
+  return width;
+}
+
+size_t TFT_ILI9341_ESP::write(uint8_t c) {
+  if (c == '\n') {
+    cursorX_ = 0;
+    cursorY_ += CHAR_HEIGHT;
+  } else if (c != '\r') {
+    fillRect(cursorX_, cursorY_, CHAR_WIDTH, CHAR_HEIGHT, textBgColor_);
+    cursorX_ += CHAR_WIDTH;
+    if (cursorX_ + CHAR_WIDTH > width_) {
+      cursorX_ = 0;
+      cursorY_ += CHAR_HEIGHT;
+    }
+  }
+  return 1;
+}
+
+bool TFT_ILI9341_ESP::writePPM(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", width_, height_);
+  for (int32_t i = 0; i < width_ * height_; i++) {
+    uint16_t c = frame_[i];
+    uint8_t rgb[3] = {(uint8_t) ((c >> 8) & 0xF8), (uint8_t) ((c >> 3) & 0xFC), (uint8_t) ((c << 3) & 0xF8)};
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,110 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// TFT_ILI9341_ESP for the host build. Draws into an RGB565 frame buffer that
+// can be saved as a PPM image, and counts the pixels pushed so render cost
+// can be compared between changes. Text is drawn as its padded background
+// box only; there are no glyphs on the host.
+#pragma once
+
+#include "Arduino.h"
+
+#define TFT_WIDTH  240
+#define TFT_HEIGHT 320
+
+#define TFT_LIGHTGREY 0xC618
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+struct GFXfont;
+
+struct HostTftStats {
+  uint32_t drawCalls;
+  uint64_t pixelsWritten;
+};
+
+class TFT_ILI9341_ESP: public Print {
+  private:
+    uint16_t frame_[TFT_WIDTH * TFT_HEIGHT];
+    int16_t width_ = TFT_WIDTH;
+    int16_t height_ = TFT_HEIGHT;
+    int32_t winX0_ = 0, winY0_ = 0, winX1_ = 0, winY1_ = 0, winX_ = 0, winY_ = 0;
+    int32_t cursorX_ = 0, cursorY_ = 0;
+    uint16_t textColor_ = 0xFFFF, textBgColor_ = 0;
+    uint8_t textDatum_ = TL_DATUM;
+    uint16_t textPadding_ = 0;
+    HostTftStats stats_ = {};
+
+    void pixel(int32_t x, int32_t y, uint16_t color);
+
+  public:
+    TFT_ILI9341_ESP(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+
+    void begin() {}
+    void setRotation(uint8_t r);
+    int16_t width() { return width_; }
+    int16_t height() { return height_; }
+
+    void fillScreen(uint16_t color);
+    void drawPixel(int32_t x, int32_t y, uint16_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    void fillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color);
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color);
+
+    void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+    void pushColors(uint8_t *data, uint32_t len);
+    void pushColor(uint16_t color);
+
+    void setTextColor(uint16_t color) { textColor_ = color; textBgColor_ = color; }
+    void setTextColor(uint16_t fgcolor, uint16_t bgcolor) { textColor_ = fgcolor; textBgColor_ = bgcolor; }
+    void setTextDatum(uint8_t datum) { textDatum_ = datum; }
+    void setTextPadding(uint16_t xWidth) { textPadding_ = xWidth; }
+    void setTextWrap(boolean wrap) {}
+    void setFreeFont(const GFXfont *font) {}
+    void setCursor(int16_t x, int16_t y) { cursorX_ = x; cursorY_ = y; }
+    int16_t textWidth(const char* string, int font = 1);
+    int16_t textWidth(const String& string, int font = 1) { return textWidth(string.c_str(), font); }
+    int16_t fontHeight(int font = 1) { return 8; }
+    int16_t drawString(const char* string, int32_t x, int32_t y, int font = 1);
+    int16_t drawString(const String& string, int32_t x, int32_t y, int font = 1) { return drawString(string.c_str(), x, y, font); }
+
+    virtual size_t write(uint8_t c);
+    using Print::write;
+
+    // Host only
+    bool writePPM(const char* path);
+    HostTftStats hostStats() { return stats_; }
+    void hostResetStats() { stats_ = {}; }
+};
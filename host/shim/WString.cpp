@@ -0,0 +1,434 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "WString.h"
+#include "HostHeap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <utility>
+
+
+static void formatUnsigned(char *buf, unsigned long value, unsigned char base) {
+  if (base == 16) {
+    sprintf(buf, "%lx", value);
+  } else if (base == 8) {
+    sprintf(buf, "%lo", value);
+  } else if (base == 2) {
+    char tmp[65];
+    int i = 64;
+    tmp[i] = 0;
+    do {
+      tmp[--i] = '0' + (value & 1);
+      value >>= 1;
+    } while (value);
+    strcpy(buf, tmp + i);
+  } else {
+    sprintf(buf, "%lu", value);
+  }
+}
+
+String::String(const char *cstr) : buffer_(nullptr), capacity_(0), len_(0) {
+  if (cstr) {
+    copy(cstr, strlen(cstr));
+  }
+}
+
+String::String(const String &str) : buffer_(nullptr), capacity_(0), len_(0) {
+  *this = str;
+}
+
+String::String(String &&rval) : buffer_(rval.buffer_), capacity_(rval.capacity_), len_(rval.len_) {
+  rval.buffer_ = nullptr;
+  rval.capacity_ = 0;
+  rval.len_ = 0;
+}
+
+String::String(char c) : buffer_(nullptr), capacity_(0), len_(0) {
+  char buf[2] = {c, 0};
+  copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long) value, base) {
+}
+
+String::String(int value, unsigned char base) : String((long) value, base) {
+}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long) value, base) {
+}
+
+String::String(long value, unsigned char base) : buffer_(nullptr), capacity_(0), len_(0) {
+  char buf[66];
+  if (base == 10 && value < 0) {
+    buf[0] = '-';
+    formatUnsigned(buf + 1, (unsigned long) -value, base);
+  } else {
+    formatUnsigned(buf, (unsigned long) value, base);
+  }
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer_(nullptr), capacity_(0), len_(0) {
+  char buf[66];
+  formatUnsigned(buf, value, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimalPlaces) : String((double) value, decimalPlaces) {
+}
+
+String::String(double value, unsigned char decimalPlaces) : buffer_(nullptr), capacity_(0), len_(0) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  hostFree(buffer_);
+}
+
+void String::invalidate() {
+  hostFree(buffer_);
+  buffer_ = nullptr;
+  capacity_ = len_ = 0;
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer_ && capacity_ >= size) {
+    return true;
+  }
+  if (changeBuffer(size)) {
+    if (len_ == 0) {
+      buffer_[0] = 0;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+  char *newbuffer = (char *) hostRealloc(buffer_, maxStrLen + 1);
+  if (newbuffer) {
+    buffer_ = newbuffer;
+    capacity_ = maxStrLen;
+    return true;
+  }
+  return false;
+}
+
+String &String::copy(const char *cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  len_ = length;
+  memcpy(buffer_, cstr, length);
+  buffer_[length] = 0;
+  return *this;
+}
+
+String &String::operator =(const String &rhs) {
+  if (this == &rhs) {
+    return *this;
+  }
+  if (rhs.buffer_) {
+    copy(rhs.buffer_, rhs.len_);
+  } else {
+    invalidate();
+  }
+  return *this;
+}
+
+String &String::operator =(const char *cstr) {
+  if (cstr) {
+    copy(cstr, strlen(cstr));
+  } else {
+    invalidate();
+  }
+  return *this;
+}
+
+String &String::operator =(String &&rval) {
+  if (this != &rval) {
+    std::swap(buffer_, rval.buffer_);
+    std::swap(capacity_, rval.capacity_);
+    std::swap(len_, rval.len_);
+  }
+  return *this;
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+  unsigned int newlen = len_ + length;
+  if (!cstr) {
+    return false;
+  }
+  if (length == 0) {
+    return true;
+  }
+  if (!reserve(newlen)) {
+    return false;
+  }
+  memmove(buffer_ + len_, cstr, length);
+  len_ = newlen;
+  buffer_[len_] = 0;
+  return true;
+}
+
+bool String::concat(const String &str) {
+  return concat(str.c_str(), str.len_);
+}
+
+bool String::concat(const char *cstr) {
+  if (!cstr) {
+    return false;
+  }
+  return concat(cstr, strlen(cstr));
+}
+
+bool String::concat(char c) {
+  return concat(&c, 1);
+}
+
+bool String::concat(int num) {
+  return concat(String(num));
+}
+
+bool String::concat(unsigned int num) {
+  return concat(String(num));
+}
+
+bool String::concat(long num) {
+  return concat(String(num));
+}
+
+bool String::concat(unsigned long num) {
+  return concat(String(num));
+}
+
+bool String::concat(double num) {
+  return concat(String(num));
+}
+
+int String::compareTo(const String &s) const {
+  return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String &s) const {
+  return len_ == s.len_ && compareTo(s) == 0;
+}
+
+bool String::equals(const char *cstr) const {
+  return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return len_ >= prefix.len_ && strncmp(c_str(), prefix.c_str(), prefix.len_) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return len_ >= suffix.len_ && strcmp(c_str() + len_ - suffix.len_, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  if (index >= len_) {
+    return 0;
+  }
+  return buffer_[index];
+}
+
+char &String::operator [](unsigned int index) {
+  static char dummy;
+  if (index >= len_) {
+    dummy = 0;
+    return dummy;
+  }
+  return buffer_[index];
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const {
+  if (!bufsize || !buf) {
+    return;
+  }
+  if (index >= len_) {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > len_ - index) {
+    n = len_ - index;
+  }
+  memcpy(buf, buffer_ + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len_) {
+    return -1;
+  }
+  const char *temp = strchr(buffer_ + fromIndex, ch);
+  return temp ? temp - buffer_ : -1;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+  if (fromIndex >= len_) {
+    return -1;
+  }
+  const char *found = strstr(buffer_ + fromIndex, str.c_str());
+  return found ? found - buffer_ : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+  if (!len_) {
+    return -1;
+  }
+  const char *temp = strrchr(buffer_, ch);
+  return temp ? temp - buffer_ : -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) {
+    std::swap(left, right);
+  }
+  String out;
+  if (left >= len_) {
+    return out;
+  }
+  if (right > len_) {
+    right = len_;
+  }
+  out.copy(buffer_ + left, right - left);
+  return out;
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (len_ == 0 || find.len_ == 0) {
+    return;
+  }
+  String out;
+  unsigned int i = 0;
+  while (i < len_) {
+    if (strncmp(buffer_ + i, find.c_str(), find.len_) == 0) {
+      out.concat(replace);
+      i += find.len_;
+    } else {
+      out.concat(buffer_[i]);
+      i++;
+    }
+  }
+  *this = std::move(out);
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len_; i++) {
+    buffer_[i] = tolower(buffer_[i]);
+  }
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len_; i++) {
+    buffer_[i] = toupper(buffer_[i]);
+  }
+}
+
+void String::trim() {
+  if (!buffer_ || len_ == 0) {
+    return;
+  }
+  char *begin = buffer_;
+  while (isspace(*begin)) {
+    begin++;
+  }
+  char *end = buffer_ + len_ - 1;
+  while (end >= begin && isspace(*end)) {
+    end--;
+  }
+  len_ = end + 1 - begin;
+  if (begin > buffer_) {
+    memmove(buffer_, begin, len_);
+  }
+  buffer_[len_] = 0;
+}
+
+long String::toInt() const {
+  return buffer_ ? atol(buffer_) : 0;
+}
+
+float String::toFloat() const {
+  return buffer_ ? atof(buffer_) : 0;
+}
+
+String operator +(const String &lhs, const String &rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, const char *rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const char *lhs, const String &rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, char rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, int rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, unsigned int rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, long rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator +(const String &lhs, unsigned long rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+bool operator ==(const char *lhs, const String &rhs) {
+  return rhs.equals(lhs);
+}
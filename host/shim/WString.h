@@ -0,0 +1,121 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Arduino String for the host build. Storage goes through the counting
+// allocator in HostHeap so allocations per poll can be measured.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class String {
+  public:
+    String(const char *cstr = "");
+    String(const String &str);
+    String(String &&rval);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+    ~String();
+
+    String &operator =(const String &rhs);
+    String &operator =(const char *cstr);
+    String &operator =(String &&rval);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len_; }
+    const char *c_str() const { return buffer_ ? buffer_ : ""; }
+
+    bool concat(const String &str);
+    bool concat(const char *cstr);
+    bool concat(const char *cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(int num);
+    bool concat(unsigned int num);
+    bool concat(long num);
+    bool concat(unsigned long num);
+    bool concat(double num);
+
+    String &operator +=(const String &rhs) { concat(rhs); return *this; }
+    String &operator +=(const char *cstr) { concat(cstr); return *this; }
+    String &operator +=(char c) { concat(c); return *this; }
+    String &operator +=(int num) { concat(num); return *this; }
+    String &operator +=(unsigned int num) { concat(num); return *this; }
+    String &operator +=(long num) { concat(num); return *this; }
+    String &operator +=(unsigned long num) { concat(num); return *this; }
+
+    int compareTo(const String &s) const;
+    bool equals(const String &s) const;
+    bool equals(const char *cstr) const;
+    bool operator ==(const String &rhs) const { return equals(rhs); }
+    bool operator ==(const char *cstr) const { return equals(cstr); }
+    bool operator !=(const String &rhs) const { return !equals(rhs); }
+    bool operator !=(const char *cstr) const { return !equals(cstr); }
+    bool startsWith(const String &prefix) const;
+    bool endsWith(const String &suffix) const;
+
+    char charAt(unsigned int index) const;
+    char operator [](unsigned int index) const { return charAt(index); }
+    char &operator [](unsigned int index);
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const String &str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, len_); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(const String &find, const String &replace);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+
+  private:
+    char *buffer_;
+    unsigned int capacity_;
+    unsigned int len_;
+
+    void invalidate();
+    bool changeBuffer(unsigned int maxStrLen);
+    String &copy(const char *cstr, unsigned int length);
+};
+
+String operator +(const String &lhs, const String &rhs);
+String operator +(const String &lhs, const char *rhs);
+String operator +(const char *lhs, const String &rhs);
+String operator +(const String &lhs, char rhs);
+String operator +(const String &lhs, int rhs);
+String operator +(const String &lhs, unsigned int rhs);
+String operator +(const String &lhs, long rhs);
+String operator +(const String &lhs, unsigned long rhs);
+bool operator ==(const char *lhs, const String &rhs);
@@ -0,0 +1,267 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+#include "WiFiClient.h"
+#include "ESP8266WiFi.h"
+#include "HostHeap.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct HostMapping {
+  std::string host;
+  std::string address;
+  uint16_t port;
+  std::string file;
+};
+
+static std::vector<HostMapping> mappings;
+static HostNetworkStats stats = {};
+
+ESP8266WiFiClass WiFi;
+
+static const HostMapping* findMapping(const char* host) {
+  for (size_t i = 0; i < mappings.size(); i++) {
+    if (mappings[i].host == host) {
+      return &mappings[i];
+    }
+  }
+  return nullptr;
+}
+
+void hostMapHostToAddress(const char* host, const char* address, uint16_t port) {
+  HostHeapPause pause;
+  HostMapping mapping = {host, address, port, ""};
+  mappings.push_back(mapping);
+}
+
+void hostMapHostToFile(const char* host, const char* path) {
+  HostHeapPause pause;
+  HostMapping mapping = {host, "", 0, path};
+  mappings.push_back(mapping);
+}
+
+void hostClearHostMappings() {
+  HostHeapPause pause;
+  mappings.clear();
+}
+
+HostNetworkStats hostNetworkStats() {
+  return stats;
+}
+
+WiFiClient::~WiFiClient() {
+  stop();
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  HostHeapPause pause;
+  stop();
+  const HostMapping* mapping = findMapping(host);
+  stats.connects++;
+  if (mapping && mapping->file.length()) {
+    FILE* f = fopen(mapping->file.c_str(), "rb");
+    if (!f) {
+      return 0;
+    }
+    std::vector<uint8_t> body;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+      body.insert(body.end(), buf, buf + n);
+    }
+    fclose(f);
+    if (body.size() < 5 || memcmp(body.data(), "HTTP/", 5) != 0) {
+      // Gzip files are served the way a compressing server would
+      bool gzip = body.size() >= 2 && body[0] == 0x1f && body[1] == 0x8b;
+      String header = String("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n") +
+                      (gzip ? "Content-Encoding: gzip\r\n" : "") + "Content-Length: " +
+                      String((unsigned long) body.size()) + "\r\nConnection: close\r\n\r\n";
+      canned_.assign(header.c_str(), header.c_str() + header.length());
+    }
+    canned_.insert(canned_.end(), body.begin(), body.end());
+    cannedPos_ = 0;
+    isCanned_ = true;
+    return 1;
+  }
+
+  String address = host;
+  if (mapping) {
+    address = mapping->address.c_str();
+    port = mapping->port;
+  }
+  struct addrinfo hints = {};
+  struct addrinfo* result = nullptr;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(address.c_str(), String(port).c_str(), &hints, &result) != 0) {
+    return 0;
+  }
+  for (struct addrinfo* ai = result; ai; ai = ai->ai_next) {
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      fd_ = fd;
+      break;
+    }
+    close(fd);
+  }
+  freeaddrinfo(result);
+  return fd_ >= 0 ? 1 : 0;
+}
+
+uint8_t WiFiClient::connected() {
+  if (isCanned_) {
+    return cannedPos_ < canned_.size();
+  }
+  if (fd_ < 0) {
+    return 0;
+  }
+  if (available() > 0) {
+    return 1;
+  }
+  uint8_t c;
+  ssize_t n = recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiClient::stop() {
+  HostHeapPause pause;
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  isCanned_ = false;
+  canned_.clear();
+  cannedPos_ = 0;
+}
+
+void WiFiClient::setNoDelay(bool nodelay) {
+  if (fd_ >= 0) {
+    int flag = nodelay ? 1 : 0;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  }
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+  if (isCanned_) {
+    stats.bytesSent += size;
+    return size;
+  }
+  if (fd_ < 0) {
+    return 0;
+  }
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = send(fd_, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      break;
+    }
+    sent += n;
+  }
+  stats.bytesSent += sent;
+  return sent;
+}
+
+int WiFiClient::available() {
+  if (isCanned_) {
+    return canned_.size() - cannedPos_;
+  }
+  if (fd_ < 0) {
+    return 0;
+  }
+  int count = 0;
+  if (ioctl(fd_, FIONREAD, &count) < 0) {
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size) {
+  if (isCanned_) {
+    size_t n = canned_.size() - cannedPos_;
+    if (n > size) {
+      n = size;
+    }
+    memcpy(buffer, canned_.data() + cannedPos_, n);
+    cannedPos_ += n;
+    stats.bytesReceived += n;
+    return n;
+  }
+  if (fd_ < 0) {
+    return -1;
+  }
+  ssize_t n = recv(fd_, buffer, size, MSG_DONTWAIT);
+  if (n <= 0) {
+    return -1;
+  }
+  stats.bytesReceived += n;
+  return n;
+}
+
+int WiFiClient::peek() {
+  if (isCanned_) {
+    return cannedPos_ < canned_.size() ? canned_[cannedPos_] : -1;
+  }
+  uint8_t c;
+  if (fd_ < 0 || recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+size_t WiFiClient::readBytes(uint8_t *buffer, size_t length) {
+  // Stream::readBytes() waits up to a second for data to arrive
+  size_t count = 0;
+  unsigned long start = millis();
+  while (count < length && millis() - start < 1000) {
+    int n = read(buffer + count, length - count);
+    if (n > 0) {
+      count += n;
+    } else if (!connected()) {
+      break;
+    }
+  }
+  return count;
+}
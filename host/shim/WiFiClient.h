@@ -0,0 +1,84 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// WiFiClient for the host build. Connects over real POSIX sockets, or, when a
+// host name has been mapped with hostMapHostToFile(), plays back a recorded
+// response from disk without touching the network.
+#pragma once
+
+#include "Arduino.h"
+
+class WiFiClient: public Print {
+  private:
+    int fd_ = -1;
+    std::vector<uint8_t> canned_;
+    size_t cannedPos_ = 0;
+    bool isCanned_ = false;
+
+  public:
+    WiFiClient() {}
+    virtual ~WiFiClient();
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(const char* host, uint16_t port);
+    int connect(const String& host, uint16_t port) { return connect(host.c_str(), port); }
+    uint8_t connected();
+    void stop();
+    void setNoDelay(bool nodelay);
+    void setTimeout(unsigned long timeout) {}
+    void flush() {}
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    int available();
+    int read();
+    int read(uint8_t *buffer, size_t size);
+    int peek();
+    size_t readBytes(uint8_t *buffer, size_t length);
+    size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t *) buffer, length); }
+
+    operator bool() { return connected(); }
+};
+
+struct HostNetworkStats {
+  uint32_t connects;
+  uint64_t bytesSent;
+  uint64_t bytesReceived;
+};
+
+// Route connections for a host name to another address, e.g. a local mock
+// server on 127.0.0.1.
+void hostMapHostToAddress(const char* host, const char* address, uint16_t port);
+
+// Answer every connection to a host name with the contents of a file. If the
+// file does not start with "HTTP/" a minimal 200 response header is added.
+void hostMapHostToFile(const char* host, const char* path);
+
+void hostClearHostMappings();
+
+HostNetworkStats hostNetworkStats();
@@ -0,0 +1,352 @@
+/**The MIT License (MIT)
+
+Copyright (c) 2015 by Daniel Eichhorn
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+See more at https://blog.squix.org
+*/
+
+// Host driver that runs the same fetch/draw cycle as loop() in the sketch,
+// without WiFi setup, splash screen or the delay between polls.
+//
+//   spotter_host --feed AircraftList.json --polls 100 --quiet
+//   spotter_host --server 127.0.0.1:8080 --ppm frame.ppm
+//   spotter_host --server 127.0.0.1:8080 --seconds 60
+//   spotter_host --sbs 127.0.0.1:30003 --seconds 10
+//   spotter_host --beast 127.0.0.1:30005 --seconds 10
+//   spotter_host --sbs 127.0.0.1:30003 --server 127.0.0.1:8080 --seconds 10
+//   spotter_host --server 127.0.0.1:8080 --seconds 60 --metrics > metrics.txt
+
+#define FS_NO_GLOBALS
+#include <FS.h>
+#include <ESP8266WiFi.h>
+#include <TFT_ILI9341_ESP.h>
+#include "HostHeap.h"
+
+#include "settings.h"
+#include "AdsbExchangeClient.h"
+#include "SbsClient.h"
+#include "ModeSClient.h"
+#include "PollScheduler.h"
+#include "Metrics.h"
+#include "GeoMap.h"
+#include "PlaneSpotter.h"
+
+TFT_ILI9341_ESP tft = TFT_ILI9341_ESP();
+StringPool stringPool;
+AircraftStore aircraftStore(&stringPool);
+FeedMerger feedMerger(&aircraftStore);
+AdsbExchangeClient adsbClient(&feedMerger);
+PollScheduler pollScheduler(&feedMerger, adsbClient.getSource());
+GeoMap geoMap(MapProvider::Google, GOOGLE_API_KEY, MAP_WIDTH, MAP_HEIGHT);
+PlaneSpotter planeSpotter(&tft, &geoMap, &stringPool);
+
+const String QUERY_STRING = "fAltL=1500";
+
+static void downloadCallback(String filename, uint32_t bytesDownloaded, uint32_t bytesTotal) {
+}
+
+static void drawFrame(Coordinates mapCenter, unsigned long now) {
+  int closest = feedMerger.findClosestAircraft();
+  planeSpotter.drawSPIFFSJpeg(geoMap.getMapName(), 0, 0);
+  for (int i = 0; i < feedMerger.getNumberOfAircrafts(); i++) {
+    Aircraft aircraft = feedMerger.getAircraft(i, now);
+    const AircraftHistory* history = feedMerger.getAircraftHistory(i);
+    if (history) {
+      planeSpotter.drawAircraftHistory(aircraft, *history);
+    }
+    planeSpotter.drawPlane(aircraft, i == closest);
+  }
+  if (closest >= 0) {
+    String fromString = planeSpotter.drawInfoBox(feedMerger.getAircraft(closest));
+    tft.setCursor(0, 228);
+    tft.fillRect(0, 220, tft.width(), tft.height() - 220, TFT_BLACK);
+    tft.print(fromString);
+  }
+  CoordinatesPixel p = geoMap.convertToPixel(mapCenter);
+  tft.fillCircle(p.x, p.y, 2, TFT_BLUE);
+  feedMerger.frameDrawn(now);
+}
+
+static void usage() {
+  fprintf(stderr,
+    "usage: spotter_host [options]\n"
+    "  --feed FILE         answer ADS-B requests with FILE\n"
+    "  --server HOST:PORT  send ADS-B requests to HOST:PORT\n"
+    "  --sbs HOST:PORT     read the SBS-1 feed of HOST:PORT instead, drawing a\n"
+    "                      frame every FRAME_INTERVAL_MILLIS\n"
+    "  --avr HOST:PORT     the same with the Mode S frames of an AVR feed\n"
+    "  --beast HOST:PORT   or of a Beast binary feed. With --feed or --server\n"
+    "                      as well, ADS-B Exchange is polled when\n"
+    "                      PollScheduler says and merged in\n"
+    "  --seconds N         how long to read the receiver feed (default 10).\n"
+    "                      Without one, polls ADS-B Exchange that long when\n"
+    "                      PollScheduler says, instead of --polls times\n"
+    "  --map FILE          JPEG the map download returns (default: none)\n"
+    "  --lat DEG --lon DEG map center (default Zurich airport)\n"
+    "  --polls N           number of fetch/draw cycles (default 1)\n"
+    "  --frames N          frames drawn per poll, each FRAME_INTERVAL_MILLIS\n"
+    "                      further along the extrapolated tracks (default 1)\n"
+    "  --ppm FILE          write the last frame as PPM image\n"
+    "  --list              print the aircraft after the last poll\n"
+    "  --gzip              ask for compressed answers\n"
+    "  --metrics           print the metrics registry after the last poll,\n"
+    "                      as the sketch dumps it over serial\n"
+    "  --quiet             silence Serial output\n");
+}
+
+int main(int argc, char** argv) {
+  Coordinates mapCenter = {47.437691, 8.568854};
+  int polls = 1;
+  int frames = 1;
+  const char* ppm = nullptr;
+  const char* map = "/dev/null";
+  bool list = false;
+  bool metrics = false;
+  FeedClient* feed = nullptr;
+  int feedBytes = 0;
+  bool adsb = false;
+  bool realtime = false;
+  int seconds = 10;
+
+  for (int i = 1; i < argc; i++) {
+    String arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--feed" && hasValue) {
+      hostMapHostToFile("global.adsbexchange.com", argv[++i]);
+      adsb = true;
+    } else if (arg == "--server" && hasValue) {
+      String server = argv[++i];
+      int colon = server.indexOf(':');
+      hostMapHostToAddress("global.adsbexchange.com", server.substring(0, colon).c_str(),
+                           colon >= 0 ? server.substring(colon + 1).toInt() : 80);
+      adsb = true;
+    } else if ((arg == "--sbs" || arg == "--avr" || arg == "--beast") && hasValue) {
+      String server = argv[++i];
+      int colon = server.indexOf(':');
+      String host = server.substring(0, colon);
+      if (arg == "--sbs") {
+        feed = new SbsClient(&feedMerger, host, colon >= 0 ? server.substring(colon + 1).toInt() : 30003);
+        feedBytes = sizeof(SbsClient);
+      } else if (arg == "--avr") {
+        feed = new ModeSClient(&feedMerger, host, colon >= 0 ? server.substring(colon + 1).toInt() : 30002, ModeSFormat::Avr);
+        feedBytes = sizeof(ModeSClient);
+      } else {
+        feed = new ModeSClient(&feedMerger, host, colon >= 0 ? server.substring(colon + 1).toInt() : 30005, ModeSFormat::Beast);
+        feedBytes = sizeof(ModeSClient);
+      }
+    } else if (arg == "--seconds" && hasValue) {
+      seconds = atoi(argv[++i]);
+      realtime = true;
+    } else if (arg == "--map" && hasValue) {
+      map = argv[++i];
+    } else if (arg == "--lat" && hasValue) {
+      mapCenter.lat = atof(argv[++i]);
+    } else if (arg == "--lon" && hasValue) {
+      mapCenter.lon = atof(argv[++i]);
+    } else if (arg == "--polls" && hasValue) {
+      polls = atoi(argv[++i]);
+    } else if (arg == "--frames" && hasValue) {
+      frames = atoi(argv[++i]);
+    } else if (arg == "--ppm" && hasValue) {
+      ppm = argv[++i];
+    } else if (arg == "--list") {
+      list = true;
+    } else if (arg == "--gzip") {
+      adsbClient.setCompression(true);
+    } else if (arg == "--metrics") {
+      metrics = true;
+    } else if (arg == "--quiet") {
+      Serial.setOutput(nullptr);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  tft.begin();
+  tft.setRotation(3);
+  tft.fillScreen(TFT_BLACK);
+  SPIFFS.begin();
+
+  hostMapHostToFile("maps.googleapis.com", map);
+  geoMap.downloadMap(mapCenter, MAP_ZOOM, downloadCallback);
+  Coordinates northWestBound = geoMap.convertToCoordinates({0, 0});
+  Coordinates southEastBound = geoMap.convertToCoordinates({MAP_WIDTH, MAP_HEIGHT});
+
+  unsigned long fetchMicros = 0;
+  unsigned long drawMicros = 0;
+  uint32_t drawAllocations = 0;
+  uint32_t connects = 0;
+  uint64_t connectMicros = 0;
+  uint64_t transferMicros = 0;
+  hostHeapResetCounters();
+  pollScheduler.setMetersPerPixel(geoMap.getMetersPerPixel());
+
+  if (feed || realtime) {
+    // Like loop() in the sketch
+    if (feed) {
+      feed->setCenter(mapCenter);
+    }
+    String query = QUERY_STRING + "&lat=" + String(mapCenter.lat, 6) + "&lng=" + String(mapCenter.lon, 6) + "&fNBnd=" + String(northWestBound.lat, 9) + "&fWBnd=" + String(northWestBound.lon, 9) + "&fSBnd=" + String(southEastBound.lat, 9) + "&fEBnd=" + String(southEastBound.lon, 9);
+    unsigned long start = millis();
+    unsigned long frameMillis = start;
+    unsigned long frameInterval = FRAME_INTERVAL_MILLIS;
+    unsigned long pollStartMillis = start;
+    polls = 0;
+    frames = 1;
+    while (millis() - start < seconds * 1000UL) {
+      unsigned long pollStart = micros();
+      if (feed) {
+        feed->poll();
+      }
+      if (adsb && adsbClient.isUpdating()) {
+        if (!adsbClient.poll()) {
+          unsigned long now = millis();
+          pollScheduler.pollFinished(adsbClient.getLastFetchStats().complete, now - pollStartMillis, now);
+        }
+      } else if (adsb && pollScheduler.isDue(millis())) {
+        pollStartMillis = millis();
+        adsbClient.startUpdate(query);
+      }
+      fetchMicros += micros() - pollStart;
+      if (millis() - frameMillis >= frameInterval) {
+        frameMillis = millis();
+        unsigned long drawStart = micros();
+        drawFrame(mapCenter, frameMillis);
+        drawMicros += micros() - drawStart;
+        unsigned long drawMillis = millis() - frameMillis;
+        Metrics.record(Metric::FrameDraw, drawMillis);
+        frameInterval = drawMillis * 2 > FRAME_INTERVAL_MILLIS ? drawMillis * 2 : FRAME_INTERVAL_MILLIS;
+        polls++;
+      } else {
+        delay(1);
+      }
+    }
+    polls = polls > 0 ? polls : 1;
+  } else {
+    for (int poll = 0; poll < polls; poll++) {
+      unsigned long start = micros();
+      adsbClient.updateVisibleAircraft(QUERY_STRING + "&lat=" + String(mapCenter.lat, 6) + "&lng=" + String(mapCenter.lon, 6) + "&fNBnd=" + String(northWestBound.lat, 9) + "&fWBnd=" + String(northWestBound.lon, 9) + "&fSBnd=" + String(southEastBound.lat, 9) + "&fEBnd=" + String(southEastBound.lon, 9));
+      unsigned long fetched = micros();
+      fetchMicros += fetched - start;
+      FetchStats fetch = adsbClient.getLastFetchStats();
+      // The interval it would wait in the sketch
+      pollScheduler.pollFinished(fetch.complete, (fetched - start) / 1000, millis());
+      connects += fetch.connects;
+      connectMicros += fetch.connectMicros;
+      transferMicros += fetch.transferMicros;
+      uint32_t allocationsBeforeDraw = hostHeapStats().allocations;
+
+      // Without the delays of the sketch, so the frames get the times they
+      // would have there
+      unsigned long polledMillis = millis();
+      for (int frame = 0; frame < frames; frame++) {
+        drawFrame(mapCenter, polledMillis + frame * FRAME_INTERVAL_MILLIS);
+      }
+      drawMicros += micros() - fetched;
+      drawAllocations += hostHeapStats().allocations - allocationsBeforeDraw;
+    }
+  }
+
+  // Without tft, the shim's frame buffer is the display's own RAM
+  aircraftStore.printMemoryReport(sizeof(feedMerger) + sizeof(adsbClient) + feedBytes
+      + sizeof(pollScheduler) + sizeof(geoMap) + sizeof(planeSpotter) + sizeof(Metrics));
+
+  if (list) {
+    for (int i = 0; i < feedMerger.getNumberOfAircrafts(); i++) {
+      Aircraft aircraft = feedMerger.getAircraft(i);
+      printf("%06X %-8s %-6s %10.6f %11.6f %5u ft %4.0f kn %5.1f deg %6.2f km  %s => %s  %s %s\n",
+             aircraft.icao, aircraft.call, feedMerger.getSourceName(aircraft.source), aircraft.lat, aircraft.lon, aircraft.altitude, aircraft.speed,
+             aircraft.heading, aircraft.distance, stringPool.get(aircraft.from), stringPool.get(aircraft.to),
+             stringPool.get(aircraft.operatorCode), stringPool.get(aircraft.aircraftType));
+    }
+  }
+
+  if (metrics) {
+    // Also if Serial was silenced
+    Serial.setOutput(stdout);
+    Metrics.dump(Serial);
+  }
+
+  HostHeapStats heap = hostHeapStats();
+  HostNetworkStats network = hostNetworkStats();
+  HostTftStats display = tft.hostStats();
+  if (feed) {
+    FeedStats stats = feed->getStats();
+    fprintf(stderr, "frames:             %d in %d s\n", polls, seconds);
+    fprintf(stderr, "aircraft (last):    %d\n", feedMerger.getNumberOfAircrafts());
+    fprintf(stderr, "messages / s:       %.1f (%u frames, %u positions, %u skipped, %u ignored)\n",
+            (double) stats.messages / seconds, stats.frames, stats.positions, stats.skipped, stats.ignored);
+    fprintf(stderr, "positions / aircraft / s: %.2f\n",
+            feedMerger.getNumberOfAircrafts() ? (double) stats.positions / seconds / feedMerger.getNumberOfAircrafts() : 0.0);
+    fprintf(stderr, "parse / frame:      %.3f ms (%.1f us / message)\n", fetchMicros / 1000.0 / polls,
+            stats.frames ? (double) fetchMicros / stats.frames : 0.0);
+    fprintf(stderr, "draw / frame:       %.3f ms\n", drawMicros / 1000.0 / polls);
+    fprintf(stderr, "bytes received:     %u (%u connects)\n", stats.bytes, stats.connects);
+    fprintf(stderr, "allocations / frame: %.1f\n", (double) heap.allocations / polls);
+    fprintf(stderr, "peak heap:          %lld bytes\n", (long long) heap.peakLiveBytes);
+  } else if (realtime) {
+    fprintf(stderr, "frames:             %d in %d s\n", polls, seconds);
+    fprintf(stderr, "aircraft (last):    %d\n", feedMerger.getNumberOfAircrafts());
+    fprintf(stderr, "fetch+parse / frame: %.3f ms\n", fetchMicros / 1000.0 / polls);
+    fprintf(stderr, "draw / frame:       %.3f ms\n", drawMicros / 1000.0 / polls);
+    fprintf(stderr, "bytes received:     %llu\n", (unsigned long long) network.bytesReceived);
+    fprintf(stderr, "peak heap:          %lld bytes\n", (long long) heap.peakLiveBytes);
+  } else {
+    fprintf(stderr, "polls:              %d\n", polls);
+    fprintf(stderr, "aircraft (last):    %d\n", feedMerger.getNumberOfAircrafts());
+    fprintf(stderr, "fetch+parse / poll: %.3f ms\n", fetchMicros / 1000.0 / polls);
+    fprintf(stderr, "  connect / poll:   %.3f ms (%.2f connects)\n", connectMicros / 1000.0 / polls, (double) connects / polls);
+    fprintf(stderr, "  transfer / poll:  %.3f ms\n", transferMicros / 1000.0 / polls);
+    fprintf(stderr, "draw / frame:       %.3f ms\n", drawMicros / 1000.0 / polls / frames);
+    fprintf(stderr, "bytes received:     %llu\n", (unsigned long long) network.bytesReceived);
+    fprintf(stderr, "allocations / poll: %.1f\n", (double) heap.allocations / polls);
+    fprintf(stderr, "  of which drawing: %.1f\n", (double) drawAllocations / polls);
+    fprintf(stderr, "peak heap:          %lld bytes\n", (long long) heap.peakLiveBytes);
+    fprintf(stderr, "pixels / frame:     %.0f\n", (double) display.pixelsWritten / polls / frames);
+  }
+
+  PollStats schedule = pollScheduler.getStats();
+  if (schedule.polls > 0) {
+    fprintf(stderr, "ADS-B polls:        %u (%u failed), interval %.0f ms mean, %u ms last\n", schedule.polls,
+            schedule.failures, (double) schedule.intervalSum / schedule.polls, schedule.lastInterval);
+    fprintf(stderr, "ADS-B p50 / p95:    first byte %u / %u ms, transfer %u / %u ms, parse %u / %u us\n",
+            Metrics.getPercentile(Metric::AdsbFirstByte, 50), Metrics.getPercentile(Metric::AdsbFirstByte, 95),
+            Metrics.getPercentile(Metric::AdsbTransfer, 50), Metrics.getPercentile(Metric::AdsbTransfer, 95),
+            Metrics.getPercentile(Metric::AdsbParse, 50), Metrics.getPercentile(Metric::AdsbParse, 95));
+  }
+  for (int source = 0; source < feedMerger.getNumberOfSources(); source++) {
+    SourceStats stats = feedMerger.getSourceStats(source);
+    if (stats.updates == 0) {
+      continue;
+    }
+    fprintf(stderr, "%-6s updates:     %u (%u stale fields dropped)\n", feedMerger.getSourceName(source),
+            stats.updates, stats.staleFields);
+    fprintf(stderr, "%-6s fix to display: %.1f ms mean, %u ms max (%u positions)\n", feedMerger.getSourceName(source),
+            stats.displayed ? (double) stats.latencySum / stats.displayed : 0.0, stats.maxLatency, stats.displayed);
+  }
+
+  if (ppm && !tft.writePPM(ppm)) {
+    fprintf(stderr, "could not write %s\n", ppm);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,340 @@
+#!/usr/bin/env python3
+"""Generate VirtualRadar AircraftList.json documents for the host benchmarks.
+
+The documents follow the layout global.adsbexchange.com returns for
+"fAltL=1500&trFmt=sa": one object per aircraft in acList, with the full set of
+VRS fields and a Cos trail of [lat, lng, time, alt] quadruples. With
+--no-trails they match "fAltL=1500", current positions only.
+
+  make_feed.py --preset dense > dense.json
+  make_feed.py --preset dense --no-trails > dense-positions.json
+  make_feed.py --preset dense --gzip > dense.json.gz
+  make_feed.py --aircraft 40 --trail 300 --seed 7 > custom.json
+"""
+import argparse
+import json
+import math
+import random
+import sys
+import zlib
+
+PRESETS = {
+    # A quiet evening in the countryside
+    "sparse": dict(aircraft=4, trail=12),
+    # Zurich/Frankfurt at noon
+    "dense": dict(aircraft=160, trail=20),
+    # Few aircraft, very long trails
+    "trails": dict(aircraft=25, trail=600),
+}
+
+# Airports as VRS names them. The first is the hub the map is centered on.
+AIRPORTS = [
+    "LSZH Zürich, Zurich, Switzerland",
+    "LSGG Geneva, Switzerland",
+    "LFSB EuroAirport Basel-Mulhouse-Freiburg, Basel, Switzerland",
+    "LSZA Lugano, Switzerland",
+    "LSZB Bern Belp, Switzerland",
+    "EDDF Frankfurt am Main, Germany",
+    "EDDM Munich, Germany",
+    "EDDB Berlin Brandenburg, Germany",
+    "EDDH Hamburg, Germany",
+    "EDDL Düsseldorf, Germany",
+    "EDDK Cologne Bonn, Germany",
+    "EDDS Stuttgart, Germany",
+    "EDDN Nuremberg, Germany",
+    "EDDW Bremen, Germany",
+    "EDDV Hannover, Germany",
+    "EDDP Leipzig/Halle, Germany",
+    "EGLL London Heathrow, United Kingdom",
+    "EGKK London Gatwick, United Kingdom",
+    "EGSS London Stansted, United Kingdom",
+    "EGLC London City, United Kingdom",
+    "EGCC Manchester, United Kingdom",
+    "EGPH Edinburgh, United Kingdom",
+    "EGBB Birmingham, United Kingdom",
+    "EIDW Dublin, Ireland",
+    "LFPG Paris Charles de Gaulle, France",
+    "LFPO Paris Orly, France",
+    "LFLL Lyon Saint Exupéry, France",
+    "LFMN Nice Côte d'Azur, France",
+    "LFML Marseille Provence, France",
+    "LFBO Toulouse Blagnac, France",
+    "LFBD Bordeaux Mérignac, France",
+    "EHAM Amsterdam Schiphol, Netherlands",
+    "EBBR Brussels, Belgium",
+    "ELLX Luxembourg Findel, Luxembourg",
+    "LEMD Madrid Barajas, Spain",
+    "LEBL Barcelona El Prat, Spain",
+    "LEPA Palma de Mallorca, Spain",
+    "LEMG Málaga Costa del Sol, Spain",
+    "LEAL Alicante Elche, Spain",
+    "LEVC Valencia, Spain",
+    "GCLP Gran Canaria, Las Palmas, Spain",
+    "GCTS Tenerife South, Spain",
+    "LPPT Lisbon Humberto Delgado, Portugal",
+    "LPPR Porto Francisco Sá Carneiro, Portugal",
+    "LPFR Faro, Portugal",
+    "LIRF Rome Fiumicino, Italy",
+    "LIMC Milan Malpensa, Italy",
+    "LIML Milan Linate, Italy",
+    "LIPZ Venice Marco Polo, Italy",
+    "LIRN Naples Capodichino, Italy",
+    "LICC Catania Fontanarossa, Italy",
+    "LIPE Bologna Guglielmo Marconi, Italy",
+    "LOWW Vienna Schwechat, Austria",
+    "LOWI Innsbruck Kranebitten, Austria",
+    "LOWS Salzburg W. A. Mozart, Austria",
+    "LKPR Prague Václav Havel, Czech Republic",
+    "EPWA Warsaw Chopin, Poland",
+    "EPKK Kraków John Paul II, Poland",
+    "LHBP Budapest Ferenc Liszt, Hungary",
+    "LDZA Zagreb Franjo Tuđman, Croatia",
+    "LDSP Split, Croatia",
+    "LDDU Dubrovnik, Croatia",
+    "LYBE Belgrade Nikola Tesla, Serbia",
+    "LROP Bucharest Henri Coandă, Romania",
+    "LBSF Sofia, Bulgaria",
+    "LGAV Athens Eleftherios Venizelos, Greece",
+    "LGTS Thessaloniki Makedonia, Greece",
+    "LGIR Heraklion Nikos Kazantzakis, Greece",
+    "LTFM Istanbul, Turkey",
+    "LTAI Antalya, Turkey",
+    "EKCH Copenhagen Kastrup, Denmark",
+    "ESSA Stockholm Arlanda, Sweden",
+    "ENGM Oslo Gardermoen, Norway",
+    "EFHK Helsinki Vantaa, Finland",
+    "BIKF Keflavík, Reykjavik, Iceland",
+    "LLBG Tel Aviv Ben Gurion, Israel",
+    "OMDB Dubai International, United Arab Emirates",
+    "OTHH Doha Hamad, Qatar",
+    "HECA Cairo, Egypt",
+    "GMMN Casablanca Mohammed V, Morocco",
+    "KJFK New York John F. Kennedy, United States",
+    "KEWR Newark Liberty, United States",
+    "KORD Chicago O'Hare, United States",
+    "CYYZ Toronto Pearson, Canada",
+    "VHHH Hong Kong, Hong Kong",
+    "WSSS Singapore Changi, Singapore",
+]
+# Share of the flights that start or end at the hub
+HUB_SHARE = 0.4
+
+OPERATORS = [
+    ("SWR", "Swiss International Air Lines"),
+    ("EDW", "Edelweiss Air"),
+    ("HBL", "Helvetic Airways"),
+    ("DLH", "Lufthansa"),
+    ("EWG", "Eurowings"),
+    ("CFG", "Condor"),
+    ("BAW", "British Airways"),
+    ("EZY", "easyJet"),
+    ("EZS", "easyJet Switzerland"),
+    ("AFR", "Air France"),
+    ("KLM", "KLM Royal Dutch Airlines"),
+    ("BEL", "Brussels Airlines"),
+    ("RYR", "Ryanair"),
+    ("AUA", "Austrian Airlines"),
+    ("IBE", "Iberia"),
+    ("VLG", "Vueling Airlines"),
+    ("TAP", "TAP Air Portugal"),
+    ("ITY", "ITA Airways"),
+    ("SAS", "Scandinavian Airlines"),
+    ("FIN", "Finnair"),
+    ("LOT", "LOT Polish Airlines"),
+    ("WZZ", "Wizz Air"),
+    ("THY", "Turkish Airlines"),
+    ("PGT", "Pegasus Airlines"),
+    ("UAE", "Emirates"),
+    ("QTR", "Qatar Airways"),
+    ("ELY", "El Al"),
+    ("UAL", "United Airlines"),
+    ("AAL", "American Airlines"),
+    ("DAL", "Delta Air Lines"),
+    ("SIA", "Singapore Airlines"),
+    ("CPA", "Cathay Pacific"),
+    ("FDX", "Federal Express"),
+    ("DHK", "DHL Air"),
+    ("NJE", "NetJets Europe"),
+]
+
+MODELS = [
+    ("A318", "Airbus A318 112", "Airbus"),
+    ("A319", "Airbus A319 112", "Airbus"),
+    ("A320", "Airbus A320 214", "Airbus"),
+    ("A20N", "Airbus A320neo 251N", "Airbus"),
+    ("A321", "Airbus A321 231", "Airbus"),
+    ("A21N", "Airbus A321neo 271NX", "Airbus"),
+    ("A332", "Airbus A330 223", "Airbus"),
+    ("A333", "Airbus A330 343", "Airbus"),
+    ("A339", "Airbus A330neo 941", "Airbus"),
+    ("A343", "Airbus A340 313X", "Airbus"),
+    ("A359", "Airbus A350 941", "Airbus"),
+    ("A35K", "Airbus A350 1041", "Airbus"),
+    ("A388", "Airbus A380 861", "Airbus"),
+    ("BCS1", "Airbus A220 100", "Airbus"),
+    ("BCS3", "Airbus A220 300", "Airbus"),
+    ("B737", "Boeing 737NG 7K2/W", "Boeing"),
+    ("B738", "Boeing 737NG 8K5/W", "Boeing"),
+    ("B38M", "Boeing 737 MAX 8", "Boeing"),
+    ("B39M", "Boeing 737 MAX 9", "Boeing"),
+    ("B752", "Boeing 757 236", "Boeing"),
+    ("B763", "Boeing 767 3Q8ER", "Boeing"),
+    ("B772", "Boeing 777 2Q8ER", "Boeing"),
+    ("B77W", "Boeing 777 3DEER", "Boeing"),
+    ("B77L", "Boeing 777 FS2", "Boeing"),
+    ("B788", "Boeing 787 8 Dreamliner", "Boeing"),
+    ("B789", "Boeing 787 9 Dreamliner", "Boeing"),
+    ("B748", "Boeing 747 8F", "Boeing"),
+    ("E170", "Embraer ERJ 170 100LR", "Embraer"),
+    ("E190", "Embraer ERJ 190 100LR", "Embraer"),
+    ("E195", "Embraer ERJ 195 200LR", "Embraer"),
+    ("E295", "Embraer E195 E2", "Embraer"),
+    ("CRJ9", "Bombardier CRJ 900LR", "Bombardier"),
+    ("DH8D", "Bombardier Dash 8 Q400", "Bombardier"),
+    ("AT76", "ATR 72 600", "ATR"),
+    ("F100", "Fokker 100", "Fokker"),
+    ("C56X", "Cessna 560XL Citation Excel", "Cessna"),
+    ("C68A", "Cessna 680A Citation Latitude", "Cessna"),
+    ("GLF6", "Gulfstream G650", "Gulfstream"),
+    ("GLEX", "Bombardier Global Express", "Bombardier"),
+    ("PC24", "Pilatus PC 24", "Pilatus"),
+]
+
+
+def aircraft(rng, index, args, now):
+    icao = 0x400000 + rng.randrange(0x3FFFFF)
+    op_icao, op = rng.choice(OPERATORS)
+    kind, model, man = rng.choice(MODELS)
+    if rng.random() < HUB_SHARE:
+        frm, to = rng.sample([AIRPORTS[0], rng.choice(AIRPORTS[1:])], 2)
+    else:
+        frm, to = rng.sample(AIRPORTS[1:], 2)
+    dist = rng.uniform(0, args.radius)
+    bearing = rng.uniform(0, 360)
+    lat = args.lat + dist / 111.0 * math.cos(math.radians(bearing))
+    lon = args.lon + dist / (111.0 * math.cos(math.radians(args.lat))) * math.sin(math.radians(bearing))
+    alt = rng.randrange(1500, 41000, 25)
+    spd = rng.uniform(140, 480)
+    trak = rng.uniform(0, 360)
+
+    cos = []
+    # Trail points go back in time, oldest first like VRS sends them
+    step = spd * 1.852 / 3600.0 * 8
+    for i in range(args.trail, 0, -1):
+        tlat = lat - step * i / 111.0 * math.cos(math.radians(trak)) + rng.uniform(-0.0005, 0.0005)
+        tlon = lon - step * i / 111.0 * math.sin(math.radians(trak)) + rng.uniform(-0.0005, 0.0005)
+        cos += [round(tlat, 6), round(tlon, 6), now - i * 8000, float(max(0, alt - i * 30))]
+    cos += [round(lat, 6), round(lon, 6), now, float(alt)]
+
+    result = {
+        "Id": icao,
+        "Rcvr": 1,
+        "HasSig": True,
+        "Sig": rng.randrange(0, 255),
+        "Icao": "%06X" % icao,
+        "Bad": False,
+        "Reg": "HB-J%s%s" % (chr(65 + index % 26), chr(65 + index // 26 % 26)),
+        "FSeen": "\\/Date(%d)\\/" % (now - 600000),
+        "TSecs": rng.randrange(10, 3000),
+        "CMsgs": rng.randrange(10, 30000),
+        "Alt": alt,
+        "GAlt": alt - 90,
+        "InHg": 29.79,
+        "AltT": 0,
+        "Call": "%s%d" % (op_icao, rng.randrange(1, 9999)),
+        "Lat": round(lat, 6),
+        "Long": round(lon, 6),
+        "PosTime": now,
+        "Mlat": False,
+        "TisB": False,
+        "Spd": round(spd, 1),
+        "Trak": round(trak, 1),
+        "TrkH": False,
+        "Type": kind,
+        "Mdl": model,
+        "Man": man,
+        "CNum": str(rng.randrange(100, 9000)),
+        "From": frm,
+        "To": to,
+        "Op": op,
+        "OpIcao": op_icao,
+        "Sqk": "%04d" % rng.randrange(0, 7777),
+        "Help": False,
+        "Vsi": rng.randrange(-2500, 2500, 64),
+        "VsiT": 0,
+        "Dst": round(dist, 2),
+        "Brng": round(bearing, 1),
+        "WTC": 2,
+        "Species": 1,
+        "Engines": "2",
+        "EngType": 3,
+        "EngMount": 0,
+        "Mil": False,
+        "Cou": "Switzerland",
+        "HasPic": False,
+        "Interested": False,
+        "FlightsCount": 0,
+        "Gnd": False,
+        "SpdTyp": 0,
+        "CallSus": False,
+        "ResetTrail": True,
+        "TT": "a",
+        "Trt": 5,
+        "Year": str(rng.randrange(1995, 2017)),
+    }
+    if not args.no_trails:
+        result["Cos"] = cos
+    return result
+
+
+def compress(body, window_bits):
+    """Gzip with a window of 2^window_bits bytes. Servers use 15, the inflater
+    in the sketch only keeps 13."""
+    compressor = zlib.compressobj(6, zlib.DEFLATED, 16 + window_bits)
+    return compressor.compress(body) + compressor.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--preset", choices=sorted(PRESETS))
+    parser.add_argument("--aircraft", type=int, default=10)
+    parser.add_argument("--trail", type=int, default=20, help="trail points per aircraft")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--lat", type=float, default=47.437691)
+    parser.add_argument("--lon", type=float, default=8.568854)
+    parser.add_argument("--radius", type=float, default=60.0, help="km around the center")
+    parser.add_argument("--no-trails", action="store_true", help="leave out Cos, as without trFmt")
+    parser.add_argument("--gzip", action="store_true", help="write the feed gzip compressed")
+    parser.add_argument("--window-bits", type=int, default=13, choices=range(9, 16), metavar="9-15",
+                        help="gzip window of 2^BITS bytes (default 13)")
+    args = parser.parse_args()
+    if args.preset:
+        for key, value in PRESETS[args.preset].items():
+            setattr(args, key, value)
+
+    rng = random.Random(args.seed)
+    now = 1486000000000
+    doc = {
+        "src": 1,
+        "feeds": [{"id": 1, "name": "From Cache", "polarPlot": False}],
+        "srcFeed": 1,
+        "showSil": True,
+        "showFlg": True,
+        "showPic": True,
+        "flgH": 20,
+        "flgW": 85,
+        "acList": [aircraft(rng, i, args, now) for i in range(args.aircraft)],
+        "totalAc": 5481,
+        "lastDv": "636216400000000000",
+        "shtTrlSec": 65,
+        "stm": now,
+    }
+    # VRS escapes '/' in the date strings; json.dumps would double escape it
+    body = json.dumps(doc, separators=(",", ":")).replace("\\\\/", "\\/").encode()
+    if args.gzip:
+        body = compress(body, args.window_bits)
+    sys.stdout.buffer.write(body)
+
+
+if __name__ == "__main__":
+    main()
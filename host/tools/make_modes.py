@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Generate raw Mode S captures in AVR or Beast format for the host tests.
+
+The aircraft fly like in make_sbs.py and send the frames a receiver picks
+up from them: extended squitters with airborne positions (even and odd in
+turn) and velocities twice a second and the identification every few
+seconds, plus altitude, identity, Comm-B and all-call replies. The Beast
+capture also holds Mode A/C replies. About one frame in a hundred has a
+bit error, as receivers that forward frames unchecked pass them on.
+
+--truth FILE writes what a decoder should end up with for each aircraft,
+from the last frame without a bit error that carries each value, one line
+per aircraft: ICAO, call sign, squawk, altitude, latitude, longitude,
+speed and track, "-" for values none of its frames carried.
+
+  make_modes.py --preset dense --truth dense.avr.truth > dense.avr
+  make_modes.py --preset dense --format beast > dense.beast
+  replay_feed.py dense.beast
+"""
+import argparse
+import math
+import random
+import sys
+
+import make_sbs
+
+# Frames per second per aircraft, by kind
+RATES = {"ident": 0.2, "position": 2.0, "velocity": 2.0, "altitude": 1.0, "identity": 0.5,
+         "commb": 0.5, "allcall": 1.0, "modeac": 0.5}
+BIT_ERROR_RATE = 0.01
+# Beast and AVR timestamps count at 12 MHz
+CLOCK = 12e6
+
+CALL_CHARACTERS = "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######"
+
+
+def crc(data):
+    remainder = 0
+    for byte in data:
+        remainder ^= byte << 16
+        for _ in range(8):
+            remainder <<= 1
+            if remainder & 0x1000000:
+                remainder ^= 0x1FFF409
+    return remainder
+
+
+def pack(fields):
+    """(value, bits) pairs, most significant first"""
+    value = 0
+    bits = 0
+    for field, count in fields:
+        value = value << count | (field & ((1 << count) - 1))
+        bits += count
+    return value.to_bytes(bits // 8, "big")
+
+
+def with_parity(data, address=0):
+    return data + (crc(data) ^ address).to_bytes(3, "big")
+
+
+def squitter(icao, me):
+    return with_parity(pack([(17, 5), (5, 3), (icao, 24)]) + me)
+
+
+def lon_zones(lat):
+    if abs(lat) >= 87.0:
+        return 1
+    a = 1 - math.cos(math.pi / 30)
+    b = math.cos(math.radians(lat)) ** 2
+    return int(math.floor(2 * math.pi / math.acos(1 - a / b)))
+
+
+def cpr(lat, lon, odd):
+    lat_zone = 360.0 / (60 - odd)
+    yz = int(math.floor(2 ** 17 * (lat % lat_zone) / lat_zone + 0.5))
+    rlat = lat_zone * (yz / 2.0 ** 17 + math.floor(lat / lat_zone))
+    lon_zone = 360.0 / max(lon_zones(rlat) - odd, 1)
+    xz = int(math.floor(2 ** 17 * (lon % lon_zone) / lon_zone + 0.5))
+    return yz & 0x1FFFF, xz & 0x1FFFF
+
+
+def altitude_code(feet):
+    """25 ft steps with the Q bit, 12 bits"""
+    n = max(0, int(round((feet + 1000) / 25.0)))
+    return (n & 0x7F0) << 1 | 0x10 | (n & 0xF)
+
+
+def identity_code(squawk):
+    """C1 A1 C2 A2 C4 A4 X B1 D1 B2 D2 B4 D4 of the octal digits ABCD"""
+    a, b, c, d = (int(digit) for digit in squawk)
+    bits = [c & 1, a & 1, c >> 1 & 1, a >> 1 & 1, c >> 2 & 1, a >> 2 & 1, 0,
+            b & 1, d & 1, b >> 1 & 1, d >> 1 & 1, b >> 2 & 1, d >> 2 & 1]
+    return sum(bit << (12 - i) for i, bit in enumerate(bits))
+
+
+def frame(kind, a, rng):
+    icao = int(a["Icao"], 16)
+    if kind == "ident":
+        call = [CALL_CHARACTERS.find(c) for c in a["Call"].upper().ljust(8)[:8]]
+        return squitter(icao, pack([(4, 5), (0, 3)] + [(c if c > 0 else 32, 6) for c in call]))
+    if kind == "position":
+        odd = a["odd"] = 1 - a.get("odd", 1)
+        lat, lon = cpr(a["Lat"], a["Long"], odd)
+        return squitter(icao, pack([(11, 5), (0, 2), (0, 1), (altitude_code(a["Alt"]), 12), (0, 1), (odd, 1),
+                                    (lat, 17), (lon, 17)]))
+    if kind == "velocity":
+        east = a["Spd"] * math.sin(math.radians(a["Trak"]))
+        north = a["Spd"] * math.cos(math.radians(a["Trak"]))
+        rate = a["Vsi"]
+        return squitter(icao, pack([(19, 5), (1, 3), (0, 1), (0, 1), (0, 3),
+                                    (east < 0, 1), (int(round(abs(east))) + 1, 10),
+                                    (north < 0, 1), (int(round(abs(north))) + 1, 10),
+                                    (0, 1), (rate < 0, 1), (int(abs(rate) / 64) + 1, 9), (0, 2), (0, 1), (0, 7)]))
+    if kind in ("altitude", "identity"):
+        code = identity_code(a["Sqk"]) if kind == "identity" else altitude_code(a["Alt"])
+        # The 13 bit altitude has the M bit in front of Q
+        code = code if kind == "identity" else (code & 0xFC0) << 1 | (code & 0x3F)
+        return with_parity(pack([(4 if kind == "altitude" else 5, 5), (0, 3), (0, 5), (0, 6), (code, 13)]), icao)
+    if kind == "commb":
+        code = altitude_code(a["Alt"])
+        code = (code & 0xFC0) << 1 | (code & 0x3F)
+        mb = bytes(rng.randrange(256) for _ in range(7))
+        return with_parity(pack([(20, 5), (0, 3), (0, 5), (0, 6), (code, 13)]) + mb, icao)
+    if kind == "allcall":
+        return with_parity(pack([(11, 5), (5, 3), (icao, 24)]))
+    # Mode A/C, 2 bytes
+    return bytes(rng.randrange(256) for _ in range(2))
+
+
+# Values each kind of frame carries, by truth column
+CARRIES = {"ident": ("call",), "position": ("alt", "lat", "lon"), "velocity": ("spd", "trak"),
+           "altitude": ("alt",), "identity": ("sqk",), "commb": ("alt",)}
+TRUTH_KEYS = {"call": "Call", "sqk": "Sqk", "alt": "Alt", "lat": "Lat", "lon": "Long", "spd": "Spd", "trak": "Trak"}
+TRUTH_COLUMNS = ("call", "sqk", "alt", "lat", "lon", "spd", "trak")
+
+
+def write_truth(path, frames):
+    truth = {}
+    for _, _, icao, values in frames:
+        if values:
+            truth.setdefault(icao, {}).update(values)
+    with open(path, "w") as f:
+        for icao in sorted(truth):
+            row = [str(truth[icao].get(column, "-")) for column in TRUTH_COLUMNS]
+            f.write("%s %s\n" % (icao, " ".join(row)))
+
+
+def flip_bit(data, rng):
+    bit = rng.randrange(len(data) * 8)
+    data = bytearray(data)
+    data[bit // 8] ^= 0x80 >> (bit % 8)
+    return bytes(data)
+
+
+def beast(stamp, signal, data):
+    kind = {2: b"1", 7: b"2", 14: b"3"}[len(data)]
+    payload = stamp.to_bytes(6, "big") + bytes([signal]) + data
+    return b"\x1a" + kind + payload.replace(b"\x1a", b"\x1a\x1a")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    make_sbs.add_arguments(parser)
+    parser.add_argument("--format", choices=("avr", "beast"), default="avr")
+    parser.add_argument("--truth", metavar="FILE", help="write the values each aircraft should decode to")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    frames = []
+    for seconds, kind, a in make_sbs.fly(args, rng, RATES):
+        if kind == "modeac" and args.format == "avr":
+            continue
+        data = frame(kind, a, rng)
+        values = {column: a[TRUTH_KEYS[column]] for column in CARRIES.get(kind, ())}
+        if "call" in values:
+            values["call"] = values["call"].upper()[:8].rstrip()
+        if rng.random() < BIT_ERROR_RATE:
+            data = flip_bit(data, rng)
+            values = None
+        frames.append((int(seconds * CLOCK), data, a["Icao"], values))
+    # Timestamps must not run backwards
+    frames.sort(key=lambda stamped: stamped[0])
+    if args.truth:
+        write_truth(args.truth, frames)
+    out = []
+    for stamp, data, _, _ in frames:
+        if args.format == "beast":
+            out.append(beast(stamp, rng.randrange(40, 255), data))
+        else:
+            out.append(b"@%012X%s;\n" % (stamp, data.hex().upper().encode()))
+    sys.stdout.buffer.write(b"".join(out))
+
+
+if __name__ == "__main__":
+    main()
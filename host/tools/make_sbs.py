@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Generate SBS-1 (BaseStation, port 30003) captures for the host tests.
+
+The aircraft are set up like make_feed.py does and fly straight for the
+length of the capture. Each one sends the mix of messages dump1090 writes
+for an aircraft in good reception: airborne positions and velocities twice
+a second, identification every few seconds and the Mode S altitude, squawk
+and all-call replies in between. Now and then a position is off by several
+kilometres, as a bad CPR decode would be.
+
+  make_sbs.py --preset dense > dense.sbs
+  replay_feed.py dense.sbs
+"""
+import argparse
+import math
+import random
+import sys
+
+import make_feed
+
+# Messages per second per aircraft, by SBS message type
+RATES = {1: 0.2, 3: 2.0, 4: 2.0, 5: 1.0, 6: 0.5, 7: 1.0, 8: 2.0}
+TICK = 0.1
+BAD_POSITION_RATE = 0.002
+
+
+def message(kind, a, seconds, rng):
+    stamp = "12:%02d:%06.3f" % (seconds // 60, seconds % 60)
+    fields = ["MSG", str(kind), "1", "1", a["Icao"], "1", "2017/02/02", stamp, "2017/02/02", stamp] + [""] * 12
+    alt = str(int(a["Alt"] // 25 * 25))
+    if kind == 1:
+        fields[10] = a["Call"].ljust(8)
+    elif kind == 3:
+        lat, lon = a["Lat"], a["Long"]
+        if rng.random() < BAD_POSITION_RATE:
+            lat += rng.choice((-1, 1)) * rng.uniform(0.05, 0.3)
+        fields[11] = alt
+        fields[14] = "%.5f" % lat
+        fields[15] = "%.5f" % lon
+        fields[18:22] = ["0", "0", "0", "0"]
+    elif kind == 4:
+        fields[12] = str(int(round(a["Spd"])))
+        fields[13] = str(int(round(a["Trak"])) % 360)
+        fields[16] = str(a["Vsi"])
+        fields[18:22] = ["0", "0", "0", "0"]
+    elif kind in (5, 7):
+        fields[11] = alt
+        fields[18:22] = ["0", "", "0", "0"] if kind == 5 else ["", "", "", "0"]
+    elif kind == 6:
+        fields[11] = alt
+        fields[17] = a["Sqk"]
+        fields[18:22] = ["0", "0", "0", "0"]
+    elif kind == 8:
+        fields[21] = "0"
+    return ",".join(fields)
+
+
+def add_arguments(parser):
+    parser.add_argument("--preset", choices=sorted(make_feed.PRESETS))
+    parser.add_argument("--aircraft", type=int, default=10)
+    parser.add_argument("--seconds", type=int, default=20, help="length of the capture")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--lat", type=float, default=47.437691)
+    parser.add_argument("--lon", type=float, default=8.568854)
+    parser.add_argument("--radius", type=float, default=60.0, help="km around the center")
+
+
+def fly(args, rng, rates):
+    """Moves the fleet in TICK steps and yields (seconds, kind, aircraft) for
+    the messages each aircraft sends, by the rates per second of each kind"""
+    if args.preset:
+        args.aircraft = make_feed.PRESETS[args.preset]["aircraft"]
+    args.trail = 0
+    args.no_trails = True
+    fleet = [make_feed.aircraft(rng, i, args, 0) for i in range(args.aircraft)]
+    for a in fleet:
+        # Squawks are octal
+        a["Sqk"] = "%04o" % rng.randrange(0, 0o7777)
+    for tick in range(int(args.seconds / TICK)):
+        seconds = tick * TICK
+        for a in rng.sample(fleet, len(fleet)):
+            km = a["Spd"] * 1.852 / 3600.0 * TICK
+            a["Lat"] += km / 111.0 * math.cos(math.radians(a["Trak"]))
+            a["Long"] += km / (111.0 * math.cos(math.radians(a["Lat"]))) * math.sin(math.radians(a["Trak"]))
+            a["Alt"] = max(0, a["Alt"] + a["Vsi"] * TICK / 60)
+            for kind, rate in rates.items():
+                if rng.random() < rate * TICK:
+                    yield seconds + rng.uniform(0, TICK), kind, a
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    add_arguments(parser)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    out = [message(kind, a, seconds, rng) for seconds, kind, a in fly(args, rng, RATES)]
+    sys.stdout.write("\r\n".join(out) + "\r\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Local stand-in for the VirtualRadar AircraftList.json endpoint.
+
+Simulates a moving set of aircraft, generated like make_feed.py does, and
+answers requests the way global.adsbexchange.com does:
+
+  - every request without fIcoQ advances the simulation by one step
+  - ldv=<lastDv of an earlier answer> returns a delta: unchanged aircraft
+    only carry their Id, changed ones their Id and the changed fields, new
+    ones all fields; aircraft that left are not listed any more
+  - trFmt=sa adds the Cos trail, fIcoQ=<ICAO> limits the answer to one
+    aircraft and does not advance the simulation
+  - Dst and Brng are only sent if the query has lat and lng
+
+  mock_vrs.py --port 8080 --preset dense
+  ./build/spotter_host --server 127.0.0.1:8080 --polls 20
+
+With --gzip, requests that send Accept-Encoding: gzip get a compressed answer.
+The server time stm advances by --step per poll; --lag makes the PosTime of
+the positions that much older, like a server that caches its feed.
+
+Each answer is logged to stderr with its size, so full and delta polls can
+be compared.
+"""
+import argparse
+import http.server
+import json
+import math
+import os
+import random
+import sys
+import urllib.parse
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import make_feed  # noqa: E402
+
+# Keys that change while an aircraft flies, everything else stays put
+MOVING_KEYS = ("Lat", "Long", "PosTime", "Alt", "GAlt", "TSecs", "CMsgs", "Sig", "Dst", "Brng")
+# Versions an ldv can go back before the answer falls back to a full list
+KEPT_VERSIONS = 32
+
+
+class Simulation:
+    def __init__(self, args):
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.now = 1486000000000
+        self.version = 636216400000000000
+        self.aircraft = [make_feed.aircraft(self.rng, i, args, self.now) for i in range(args.aircraft)]
+        self.added = args.aircraft
+        self.snapshots = {}
+        self.snapshot()
+
+    def snapshot(self):
+        self.snapshots[self.version] = {a["Id"]: {k: v for k, v in a.items() if k != "Cos"} for a in self.aircraft}
+        for version in [v for v in self.snapshots if v <= self.version - KEPT_VERSIONS]:
+            del self.snapshots[version]
+
+    def step(self):
+        seconds = self.args.step
+        self.now += seconds * 1000
+        self.version += 1
+        for a in self.aircraft:
+            km = a["Spd"] * 1.852 / 3600.0 * seconds
+            a["Lat"] = round(a["Lat"] + km / 111.0 * math.cos(math.radians(a["Trak"])), 6)
+            a["Long"] = round(a["Long"] + km / 111.0 * math.sin(math.radians(a["Trak"])), 6)
+            a["Alt"] = max(0, a["Alt"] + a["Vsi"] * seconds // 60)
+            a["GAlt"] = a["Alt"] - 90
+            a["PosTime"] = self.now - int(self.args.lag * 1000)
+            a["TSecs"] += seconds
+            a["CMsgs"] += self.rng.randrange(5, 50)
+            a["Sig"] = self.rng.randrange(0, 255)
+            dy = (a["Lat"] - self.args.lat) * 111.0
+            dx = (a["Long"] - self.args.lon) * 111.0 * math.cos(math.radians(self.args.lat))
+            a["Dst"] = round(math.hypot(dx, dy), 2)
+            a["Brng"] = round(math.degrees(math.atan2(dx, dy)) % 360, 1)
+            a["Cos"] = a["Cos"][4:] + [a["Lat"], a["Long"], self.now, float(a["Alt"])]
+        # Aircraft come and go
+        for _ in range(self.args.churn):
+            if self.aircraft:
+                self.aircraft.pop(self.rng.randrange(len(self.aircraft)))
+            self.aircraft.append(make_feed.aircraft(self.rng, self.added, self.args, self.now))
+            self.added += 1
+        self.snapshot()
+
+    def document(self, query):
+        icao = query.get("fIcoQ", [None])[0]
+        if icao is None:
+            self.step()
+        trails = "trFmt" in query
+        located = "lat" in query and "lng" in query
+        ldv = query.get("ldv", [None])[0]
+        old = self.snapshots.get(int(ldv)) if ldv and ldv.isdigit() else None
+
+        ac_list = []
+        for a in self.aircraft:
+            if icao is not None and a["Icao"] != icao:
+                continue
+            item = {k: v for k, v in a.items() if (trails or k != "Cos") and (located or k not in ("Dst", "Brng"))}
+            before = old.get(a["Id"]) if old is not None and icao is None else None
+            if before is not None:
+                item = {k: v for k, v in item.items() if k == "Id" or k == "Cos" or before.get(k) != v}
+            ac_list.append(item)
+        doc = {
+            "src": 1,
+            "feeds": [{"id": 1, "name": "From Cache", "polarPlot": False}],
+            "srcFeed": 1,
+            "showSil": True,
+            "showFlg": True,
+            "showPic": True,
+            "flgH": 20,
+            "flgW": 85,
+            "acList": ac_list,
+            "totalAc": 5481,
+            "lastDv": str(self.version),
+            "shtTrlSec": 65,
+            "stm": self.now,
+        }
+        return json.dumps(doc, separators=(",", ":")).replace("\\\\/", "\\/").encode()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--preset", choices=sorted(make_feed.PRESETS))
+    parser.add_argument("--aircraft", type=int, default=10)
+    parser.add_argument("--trail", type=int, default=20, help="trail points per aircraft")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--lat", type=float, default=47.437691)
+    parser.add_argument("--lon", type=float, default=8.568854)
+    parser.add_argument("--radius", type=float, default=60.0, help="km around the center")
+    parser.add_argument("--step", type=int, default=5, help="seconds the aircraft move per poll")
+    parser.add_argument("--churn", type=int, default=1, help="aircraft replaced per poll")
+    parser.add_argument("--lag", type=float, default=0.0,
+                        help="seconds the positions are older than the server time stm")
+    parser.add_argument("--no-delta", action="store_true", help="ignore ldv and always answer the full list")
+    parser.add_argument("--close", action="store_true", help="close the connection after each response")
+    parser.add_argument("--chunked", type=int, default=0, metavar="BYTES",
+                        help="send the body in chunks of BYTES with Transfer-Encoding: chunked")
+    parser.add_argument("--gzip", action="store_true", help="compress the body if the request accepts gzip")
+    parser.add_argument("--window-bits", type=int, default=13, choices=range(9, 16), metavar="9-15",
+                        help="gzip window of 2^BITS bytes (default 13)")
+    args = parser.parse_args()
+    if args.preset:
+        for key, value in make_feed.PRESETS[args.preset].items():
+            setattr(args, key, value)
+    args.no_trails = False
+    simulation = Simulation(args)
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+        # Headers and body go out in separate writes. With Nagle the body
+        # waits for the delayed ACK of the headers on a kept connection.
+        disable_nagle_algorithm = True
+
+        def do_GET(self):
+            query = urllib.parse.parse_qs(urllib.parse.urlparse(self.path).query)
+            if args.no_delta:
+                query.pop("ldv", None)
+            body = simulation.document(query)
+            kind = "trail" if "fIcoQ" in query else "delta" if "ldv" in query else "full"
+            gzip = args.gzip and "gzip" in self.headers.get("Accept-Encoding", "")
+            if gzip:
+                compressed = make_feed.compress(body, args.window_bits)
+                sys.stderr.write("%-5s %7d bytes, %6d gzip  %s\n" % (kind, len(body), len(compressed), self.path))
+                body = compressed
+            else:
+                sys.stderr.write("%-5s %7d bytes  %s\n" % (kind, len(body), self.path))
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            if gzip:
+                self.send_header("Content-Encoding", "gzip")
+            if args.chunked:
+                self.send_header("Transfer-Encoding", "chunked")
+            else:
+                self.send_header("Content-Length", str(len(body)))
+            if args.close:
+                self.send_header("Connection", "close")
+            self.end_headers()
+            if args.chunked:
+                for i in range(0, len(body), args.chunked):
+                    chunk = body[i:i + args.chunked]
+                    self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+                self.wfile.write(b"0\r\n\r\n")
+            else:
+                self.wfile.write(body)
+            self.close_connection = args.close
+
+        def log_message(self, format, *args):
+            pass
+
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    sys.stderr.write("mock VRS on 127.0.0.1:%d with %d aircraft\n" % (args.port, len(simulation.aircraft)))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Local stand-in for the network outputs of dump1090.
+
+Replays a capture to every client that connects, paced by the time stamps
+of the messages, the way a receiver sends them. The extension tells the
+format: .sbs for BaseStation (port 30003), .avr for AVR (30002) and .beast
+for Beast binary (30005), as make_sbs.py and make_modes.py write them.
+
+  replay_feed.py --port 30003 dense.sbs
+  ./build/spotter_host --sbs 127.0.0.1:30003 --seconds 10
+  replay_feed.py --port 30005 dense.beast
+  ./build/spotter_host --beast 127.0.0.1:30005 --seconds 10
+
+With --loop the capture starts over when it ends. The aircraft then jump
+back to where they were at its start.
+"""
+import argparse
+import os
+import socket
+import socketserver
+import sys
+import time
+
+# AVR and Beast timestamps count at 12 MHz
+CLOCK = 12e6
+
+
+def offset(line):
+    """Seconds of the generation time stamp, field 8"""
+    fields = line.split(b",")
+    if len(fields) < 8 or not fields[7]:
+        return None
+    hours, minutes, seconds = fields[7].split(b":")
+    return int(hours) * 3600 + int(minutes) * 60 + float(seconds)
+
+
+def sbs_messages(data):
+    for line in data.splitlines():
+        at = offset(line)
+        if at is not None:
+            yield at, line + b"\r\n"
+
+
+def avr_messages(data):
+    """"@" lines with a 12 MHz timestamp"""
+    for line in data.splitlines():
+        if line.startswith(b"@") and len(line) > 13:
+            yield int(line[1:13], 16) / CLOCK, line + b"\n"
+
+
+def beast_messages(data):
+    """0x1A, type, 6 byte 12 MHz timestamp, signal, frame, 0x1A doubled"""
+    starts = []
+    i = 0
+    while i < len(data):
+        if data[i] == 0x1A:
+            if data[i + 1:i + 2] == b"\x1a":
+                i += 1
+            else:
+                starts.append(i)
+        i += 1
+    for start, end in zip(starts, starts[1:] + [len(data)]):
+        message = data[start:end]
+        payload = message[2:].replace(b"\x1a\x1a", b"\x1a")
+        yield int.from_bytes(payload[:6], "big") / CLOCK, message
+
+
+READERS = {".sbs": sbs_messages, ".avr": avr_messages, ".beast": beast_messages}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture")
+    parser.add_argument("--port", type=int, default=30003)
+    parser.add_argument("--speed", type=float, default=1.0, help="replay this many times faster")
+    parser.add_argument("--loop", action="store_true", help="start over at the end of the capture")
+    args = parser.parse_args()
+
+    extension = os.path.splitext(args.capture)[1]
+    if extension not in READERS:
+        parser.error("capture must end in " + ", ".join(sorted(READERS)))
+    lines = []
+    first = None
+    with open(args.capture, "rb") as capture:
+        for at, line in READERS[extension](capture.read()):
+            if first is None:
+                first = at
+            lines.append((at - first, line))
+    length = lines[-1][0] + 0.1 if lines else 0
+
+    class Handler(socketserver.BaseRequestHandler):
+        def handle(self):
+            self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            start = time.monotonic()
+            sent = 0
+            lap = 0
+            try:
+                while True:
+                    for at, line in lines:
+                        due = start + (lap * length + at) / args.speed
+                        wait = due - time.monotonic()
+                        if wait > 0.01:
+                            time.sleep(wait)
+                        self.request.sendall(line)
+                        sent += 1
+                    if not args.loop:
+                        break
+                    lap += 1
+            except OSError:
+                pass
+            sys.stderr.write("%s: %d messages\n" % (self.client_address[0], sent))
+
+    socketserver.ThreadingTCPServer.allow_reuse_address = True
+    server = socketserver.ThreadingTCPServer(("127.0.0.1", args.port), Handler)
+    server.daemon_threads = True
+    sys.stderr.write("Replay of %d messages over %.1f s on 127.0.0.1:%d\n" % (len(lines), length, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -40,3 +40,31 @@ See more at https://blog.squix.org
 #define MAP_HEIGHT 200
 
 
+
+// The aircraft are redrawn at their extrapolated positions at most every
+// FRAME_INTERVAL_MILLIS, also while a poll is running, and less often if a
+// frame takes more than half of it to draw (see Metrics, frame.draw).
+// PollScheduler decides when the next poll of ADS-B Exchange starts.
+#define FRAME_INTERVAL_MILLIS 100
+
+// A receiver on the local network with BaseStation output, such as dump1090
+// started with --net. If set, the aircraft come from there as they are
+// received instead of from ADS-B Exchange.
+#define SBS_HOST ""
+#define SBS_PORT 30003
+
+// Or a receiver that forwards the raw Mode S frames, decoded by the spotter:
+// dump1090's Beast output on port 30005 (ModeSFormat::Beast) or its AVR
+// output on 30002 (ModeSFormat::Avr). SBS_HOST wins if both are set.
+#define MODES_HOST ""
+#define MODES_PORT 30005
+#define MODES_FORMAT ModeSFormat::Beast
+
+// Keeps polling ADS-B Exchange with a receiver set. The receiver's fresher
+// positions win, ADS-B Exchange fills in routes, models and aircraft out of
+// the receiver's range.
+#define ADSB_EXCHANGE_WITH_RECEIVER false
+
+// The fetch and parse metrics are written to the serial port when an 'm'
+// arrives on it, and this often if not 0
+#define METRICS_DUMP_INTERVAL_MILLIS 0